@@ -0,0 +1,404 @@
+using Gtk;
+
+namespace Sambo {
+    /**
+     * Mesures d'une passe du banc d'essai, à un débit donné
+     */
+    private class StreamRunStats {
+        public double rate;
+        public Gee.ArrayList<double?> frame_times = new Gee.ArrayList<double?>();     // ms
+        public Gee.ArrayList<double?> loop_latencies = new Gee.ArrayList<double?>();  // ms
+        public int64 tokens_emitted = 0;       // Tokens produits par la source synthétique
+        public int content_updates = 0;        // Mises à jour du message reçues par la vue
+        public int displayed_updates = 0;      // Mises à jour effectivement peintes
+        public int64 main_thread_cpu_ns = 0;
+        public double duration = 0.0;          // s
+        public bool success = false;
+
+        public int dropped_updates() {
+            return content_updates - displayed_updates;
+        }
+
+        public double cpu_per_token_us() {
+            return tokens_emitted > 0 ? main_thread_cpu_ns / 1000.0 / tokens_emitted : 0.0;
+        }
+
+        public static double percentile(Gee.ArrayList<double?> values, double fraction) {
+            if (values.size == 0) {
+                return 0.0;
+            }
+            var sorted = new Gee.ArrayList<double?>();
+            sorted.add_all(values);
+            sorted.sort((a, b) => {
+                double x = a;
+                double y = b;
+                return x < y ? -1 : (x > y ? 1 : 0);
+            });
+            int index = ((int) Math.ceil(fraction * sorted.size) - 1).clamp(0, sorted.size - 1);
+            return sorted[index];
+        }
+    }
+
+    /**
+     * Banc d'essai du pipeline de streaming ModelManager → ChatView
+     *
+     * Le wrapper est placé sur sa source de tokens synthétique : aucun modèle
+     * n'est lu, mais les tokens traversent le même chemin qu'en production
+     * (callback C, Idle.add, ChatMessage, ChatBubbleRow). Pour chaque débit
+     * demandé, une réponse est générée dans une vraie fenêtre et l'on relève
+     * la durée des frames (update + layout + paint), la latence de la boucle
+     * principale, les mises à jour jamais affichées et le temps CPU du thread
+     * principal par token.
+     *
+     * GTK a besoin d'un affichage : en CI, lancer sous xvfb-run ou avec
+     * GDK_BACKEND=broadway. La configuration est isolée dans un dossier
+     * temporaire. Code de sortie 1 si un seuil est dépassé, 2 si une passe échoue.
+     *
+     * Exemple : xvfb-run build/sambo-stream-bench --rates 50,100,200 --max-frame-ms 16 2>/dev/null
+     */
+    public class StreamBenchmark : Adw.Application {
+        private const uint PROBE_INTERVAL_MS = 4;
+        private const uint PAUSE_BETWEEN_RUNS_MS = 500;
+        private const uint MODEL_WAIT_MS = 5000;
+
+        private const string DEFAULT_RATES = "20,50,100,200,400";
+
+        private static string? rates_option = null;
+        private static int tokens_option = 600;
+        private static int min_chars_option = 1;
+        private static double mean_chars_option = 4.0;
+        private static int max_chars_option = 12;
+        private static double jitter_option = 0.2;
+        private static double max_frame_ms_option = 0.0;
+        private static double max_latency_ms_option = 0.0;
+
+        private const OptionEntry[] OPTIONS = {
+            { "rates", 'r', OptionFlags.NONE, OptionArg.STRING, ref rates_option, "Débits testés, en tokens/s", "20,50,..." },
+            { "tokens", 'n', OptionFlags.NONE, OptionArg.INT, ref tokens_option, "Tokens générés par passe", "N" },
+            { "min-chars", 0, OptionFlags.NONE, OptionArg.INT, ref min_chars_option, "Taille minimale d'un token (caractères)", "N" },
+            { "mean-chars", 0, OptionFlags.NONE, OptionArg.DOUBLE, ref mean_chars_option, "Taille moyenne d'un token (caractères)", "X" },
+            { "max-chars", 0, OptionFlags.NONE, OptionArg.INT, ref max_chars_option, "Taille maximale d'un token (caractères)", "N" },
+            { "jitter", 0, OptionFlags.NONE, OptionArg.DOUBLE, ref jitter_option, "Variation relative de l'intervalle entre tokens (0-1)", "X" },
+            { "max-frame-ms", 0, OptionFlags.NONE, OptionArg.DOUBLE, ref max_frame_ms_option, "Seuil du p95 de durée de frame (0 = aucun)", "MS" },
+            { "max-latency-ms", 0, OptionFlags.NONE, OptionArg.DOUBLE, ref max_latency_ms_option, "Seuil du p95 de latence de la boucle principale (0 = aucun)", "MS" },
+            { null }
+        };
+
+        private static int exit_status = 0;
+
+        private double[] rates = {};
+        private int run_index = 0;
+        private string model_path;
+
+        private ApplicationController controller;
+        private ApplicationModel model;
+        private Adw.ApplicationWindow window;
+        private ChatView chat_view;
+
+        // Passe en cours
+        private StreamRunStats? current = null;
+        private ChatMessage? live_message = null;
+        private ulong live_notify_id = 0;
+        private bool update_pending = false;
+        private int64 paint_start = 0;
+        private int64 last_probe = 0;
+        private uint probe_id = 0;
+        private uint guard_id = 0;
+        private int64 cpu_start = 0;
+        private int64 emitted_start = 0;
+        private int64 run_start = 0;
+        private Gee.ArrayList<StreamRunStats> results = new Gee.ArrayList<StreamRunStats>();
+
+        public StreamBenchmark(double[] rates, string model_path) {
+            Object(application_id: "com.cabineteto.Sambo.StreamBench", flags: ApplicationFlags.NON_UNIQUE);
+            this.rates = rates;
+            this.model_path = model_path;
+        }
+
+        protected override void activate() {
+            controller = new ApplicationController(null, this);
+            model = new ApplicationModel(controller);
+            controller.set_model(model);
+
+            // Profil dédié pointant sur le modèle factice
+            var config = controller.get_config_manager();
+            var profile = InferenceProfile.create_default("stream-bench", "Banc d'essai streaming");
+            profile.model_path = model_path;
+            profile.max_tokens = tokens_option;
+            profile.seed = 42;
+            profile.stream = true;
+            config.save_profile(profile);
+            config.select_profile(profile.id);
+
+            window = new Adw.ApplicationWindow(this);
+            window.set_default_size(900, 700);
+            chat_view = new ChatView(controller);
+            window.set_content(chat_view);
+            chat_view.response_finished.connect(on_response_finished);
+            chat_view.get_conversation_store().items_changed.connect(on_items_changed);
+            window.present();
+
+            var frame_clock = window.get_frame_clock();
+            frame_clock.before_paint.connect(() => {
+                paint_start = get_monotonic_time();
+            });
+            frame_clock.after_paint.connect(on_after_paint);
+
+            // Attendre que le ChatView ait chargé le modèle du profil
+            var wait_start = get_monotonic_time();
+            Timeout.add(100, () => {
+                if (controller.get_model_manager().is_model_ready()) {
+                    start_run();
+                    return Source.REMOVE;
+                }
+                if (get_monotonic_time() - wait_start > MODEL_WAIT_MS * 1000) {
+                    stderr.printf("[PERF] STREAMBENCH: Modèle synthétique non chargé\n");
+                    exit_status = 2;
+                    quit();
+                    return Source.REMOVE;
+                }
+                return Source.CONTINUE;
+            });
+        }
+
+        private void start_run() {
+            double rate = rates[run_index];
+            Llama.set_synthetic_backend(true, rate, jitter_option, min_chars_option, mean_chars_option, max_chars_option);
+
+            current = new StreamRunStats();
+            current.rate = rate;
+            update_pending = false;
+            emitted_start = Llama.get_synthetic_tokens_emitted();
+            cpu_start = read_main_thread_cpu_ns();
+            run_start = get_monotonic_time();
+
+            // Sonde de latence : une source périodique de priorité normale
+            last_probe = run_start;
+            probe_id = Timeout.add(PROBE_INTERVAL_MS, () => {
+                int64 now = get_monotonic_time();
+                double lateness = (now - last_probe) / 1000.0 - PROBE_INTERVAL_MS;
+                current.loop_latencies.add(double.max(0.0, lateness));
+                last_probe = now;
+                return Source.CONTINUE;
+            });
+
+            // Garde-fou si la réponse ne se termine jamais
+            uint guard_seconds = (uint) (tokens_option / rate * 3.0) + 10;
+            guard_id = Timeout.add_seconds(guard_seconds, () => {
+                guard_id = 0;
+                stderr.printf("[PERF] STREAMBENCH: Délai dépassé à %.0f tokens/s\n", rate);
+                finish_run(false);
+                return Source.REMOVE;
+            });
+
+            chat_view.send_message("Banc d'essai : %.0f tokens/s".printf(rate));
+        }
+
+        private void on_items_changed(uint position, uint removed, uint added) {
+            if (current == null || added == 0) {
+                return;
+            }
+            var store = chat_view.get_conversation_store();
+            var message = store.get_item(store.get_n_items() - 1) as ChatMessage;
+            if (message == null || message.sender != ChatMessage.SenderType.AI || message == live_message) {
+                return;
+            }
+            disconnect_live_message();
+            live_message = message;
+            live_notify_id = message.notify["content"].connect(() => {
+                if (current != null) {
+                    current.content_updates++;
+                    update_pending = true;
+                }
+            });
+        }
+
+        private void on_after_paint() {
+            if (current == null || paint_start == 0) {
+                return;
+            }
+            current.frame_times.add((get_monotonic_time() - paint_start) / 1000.0);
+            if (update_pending) {
+                current.displayed_updates++;
+                update_pending = false;
+            }
+        }
+
+        private void on_response_finished(bool success) {
+            if (current != null) {
+                finish_run(success);
+            }
+        }
+
+        private void finish_run(bool success) {
+            if (probe_id != 0) {
+                Source.remove(probe_id);
+                probe_id = 0;
+            }
+            if (guard_id != 0) {
+                Source.remove(guard_id);
+                guard_id = 0;
+            }
+            disconnect_live_message();
+
+            current.success = success;
+            current.duration = (get_monotonic_time() - run_start) / 1000000.0;
+            current.tokens_emitted = Llama.get_synthetic_tokens_emitted() - emitted_start;
+            current.main_thread_cpu_ns = read_main_thread_cpu_ns() - cpu_start;
+            results.add(current);
+            current = null;
+
+            if (!success) {
+                controller.get_model_manager().cancel_generation();
+            }
+
+            run_index++;
+            if (run_index < rates.length) {
+                Timeout.add(PAUSE_BETWEEN_RUNS_MS, () => {
+                    chat_view.get_conversation_store().start_new_conversation();
+                    start_run();
+                    return Source.REMOVE;
+                });
+            } else {
+                print_report();
+                quit();
+            }
+        }
+
+        private void disconnect_live_message() {
+            if (live_message != null && live_notify_id != 0) {
+                live_message.disconnect(live_notify_id);
+            }
+            live_message = null;
+            live_notify_id = 0;
+        }
+
+        private void print_report() {
+            stdout.printf("\n%-9s %7s %8s %9s %9s %9s %9s %9s %10s %8s\n",
+                "tokens/s", "tokens", "frames", "frame p50", "frame p95", "frame max",
+                "boucle p95", "boucle max", "non peintes", "CPU/tok");
+            stdout.printf("%-9s %7s %8s %9s %9s %9s %9s %9s %10s %8s\n",
+                "", "", "", "(ms)", "(ms)", "(ms)", "(ms)", "(ms)", "", "(µs)");
+
+            foreach (var run in results) {
+                double frame_p95 = StreamRunStats.percentile(run.frame_times, 0.95);
+                double loop_p95 = StreamRunStats.percentile(run.loop_latencies, 0.95);
+                stdout.printf("%-9.0f %7s %8d %9.2f %9.2f %9.2f %9.2f %9.2f %10d %8.1f%s\n",
+                    run.rate, run.tokens_emitted.to_string(), run.frame_times.size,
+                    StreamRunStats.percentile(run.frame_times, 0.5), frame_p95,
+                    StreamRunStats.percentile(run.frame_times, 1.0),
+                    loop_p95, StreamRunStats.percentile(run.loop_latencies, 1.0),
+                    run.dropped_updates(), run.cpu_per_token_us(),
+                    run.success ? "" : "  ÉCHEC");
+
+                if (!run.success) {
+                    exit_status = 2;
+                } else if (exit_status == 0 &&
+                           ((max_frame_ms_option > 0 && frame_p95 > max_frame_ms_option) ||
+                            (max_latency_ms_option > 0 && loop_p95 > max_latency_ms_option))) {
+                    exit_status = 1;
+                }
+            }
+
+            stdout.printf("\nFrames : durée update + layout + paint. Boucle : retard d'une source de %u ms.\n", PROBE_INTERVAL_MS);
+            stdout.printf("Non peintes : mises à jour du message remplacées avant d'atteindre l'écran.\n");
+            stdout.printf("CPU/tok : temps CPU du thread principal divisé par le nombre de tokens.\n");
+            if (exit_status == 1) {
+                stdout.printf("Seuil dépassé.\n");
+            }
+        }
+
+        /**
+         * Temps CPU du thread principal en nanosecondes (/proc/self/schedstat)
+         */
+        private static int64 read_main_thread_cpu_ns() {
+            try {
+                string contents;
+                FileUtils.get_contents("/proc/self/schedstat", out contents);
+                return int64.parse(contents.split(" ")[0]);
+            } catch (Error e) {
+                warning("Lecture de /proc/self/schedstat impossible : %s", e.message);
+                return 0;
+            }
+        }
+
+        public static int main(string[] args) {
+            var context = new OptionContext("- banc d'essai du streaming ModelManager → ChatView");
+            context.add_main_entries(OPTIONS, null);
+            try {
+                context.parse(ref args);
+            } catch (OptionError e) {
+                stderr.printf("%s\n", e.message);
+                return 2;
+            }
+
+            double[] rates = {};
+            foreach (string item in (rates_option ?? DEFAULT_RATES).split(",")) {
+                double rate = double.parse(item.strip());
+                if (rate > 0) {
+                    rates += rate;
+                }
+            }
+            if (rates.length == 0 || tokens_option <= 0) {
+                stderr.printf("Aucun débit valide\n");
+                return 2;
+            }
+
+            // Configuration, historique et caches isolés de ceux de l'utilisateur,
+            // avant tout appel qui mettrait en cache les dossiers XDG
+            string root;
+            try {
+                root = DirUtils.make_tmp("sambo-bench-XXXXXX");
+            } catch (FileError e) {
+                stderr.printf("Dossier temporaire impossible : %s\n", e.message);
+                return 2;
+            }
+            int status = run_isolated(root, rates, args[0]);
+            remove_tree(root);
+            return status;
+        }
+
+        private static int run_isolated(string root, double[] rates, string program) {
+            Environment.set_variable("HOME", root, true);
+            Environment.set_variable("XDG_CONFIG_HOME", Path.build_filename(root, "config"), true);
+            Environment.set_variable("XDG_CACHE_HOME", Path.build_filename(root, "cache"), true);
+            Environment.set_variable("XDG_DATA_HOME", Path.build_filename(root, "data"), true);
+
+            // Le chargement d'un modèle exige un fichier existant ; la source synthétique ne le lit pas
+            string model_path = Path.build_filename(root, "synthetic.gguf");
+            try {
+                FileUtils.set_contents(model_path, "");
+            } catch (FileError e) {
+                stderr.printf("Modèle factice impossible : %s\n", e.message);
+                return 2;
+            }
+
+            Llama.set_synthetic_backend(true, rates[0], jitter_option, min_chars_option, mean_chars_option, max_chars_option);
+
+            Adw.init();
+            var app = new StreamBenchmark(rates, model_path);
+            app.run({ program });
+            return exit_status;
+        }
+
+        /**
+         * Supprime le dossier temporaire du banc d'essai, sans suivre les liens
+         */
+        private static void remove_tree(string path) {
+            if (FileUtils.test(path, FileTest.IS_DIR) && !FileUtils.test(path, FileTest.IS_SYMLINK)) {
+                try {
+                    var dir = Dir.open(path);
+                    string? name;
+                    while ((name = dir.read_name()) != null) {
+                        remove_tree(Path.build_filename(path, name));
+                    }
+                } catch (FileError e) {
+                    warning("Nettoyage de %s impossible : %s", path, e.message);
+                }
+                DirUtils.remove(path);
+            } else {
+                FileUtils.unlink(path);
+            }
+        }
+    }
+}
@@ -8,6 +8,9 @@ namespace Sambo {
         // Signal pour notifier les commandes de terminal
         public signal void terminal_command_signal(string command, string output);
 
+        // Signal pour transmettre un document de l'éditeur au chat
+        public signal void document_sent_to_chat(PivotDocument document, string title);
+
         private ApplicationModel? model;
         private Gtk.Application application;
         private ExplorerWindow? explorer_window = null;
@@ -478,6 +481,20 @@ namespace Sambo {
             return model.model_manager;
         }
 
+        /**
+         * Obtient la file des traitements par lot
+         */
+        public BatchJobManager get_batch_job_manager() {
+            return model.batch_jobs;
+        }
+
+        /**
+         * Transmet un document de l'éditeur au chat pour un traitement map-reduce
+         */
+        public void send_document_to_chat(PivotDocument document, string title) {
+            document_sent_to_chat(document, title);
+        }
+
         /**
          * Génère une réponse IA avec les paramètres fournis
          * @param prompt Le prompt complet
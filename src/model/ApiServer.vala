@@ -0,0 +1,474 @@
+namespace Sambo {
+    /**
+     * Serveur HTTP local compatible avec l'API OpenAI
+     *
+     * Expose le modèle déjà chargé par ModelManager aux outils externes sur
+     * 127.0.0.1, sans second chargement : /v1/models, /v1/completions et
+     * /v1/chat/completions (avec streaming SSE). Les générations passent par
+     * le GenerationScheduler, qui alterne équitablement avec la session de chat.
+     *
+     * Désactivé par défaut : [Server] enabled=true et port dans la configuration.
+     */
+    public class ApiServer : Object {
+        private const int DEFAULT_PORT = 8089;
+        private const uint FLUSH_INTERVAL_MS = 30;
+        private const string API_CLIENT_PREFIX = "api";
+
+        private ConfigManager config_manager;
+        private ModelManager model_manager;
+        private Soup.Server? server = null;
+        private Gee.HashSet<ApiRequest> active_requests = new Gee.HashSet<ApiRequest>();
+        private uint request_counter = 0;
+
+        /**
+         * État d'une requête de génération, partagé entre le thread de
+         * génération et le thread principal
+         */
+        private class ApiRequest : Object {
+            public Soup.ServerMessage msg;
+            public string id;
+            public string model_name;
+            public int64 created;
+            public bool chat;
+            public bool stream;
+            public int max_tokens;
+            public int64 start_time;
+            public Cancellable cancellable = new Cancellable();
+
+            public Mutex mutex = Mutex();
+            public StringBuilder pending = new StringBuilder();
+            public StringBuilder full_text = new StringBuilder();
+            public int token_count = 0;
+            public bool flush_scheduled = false;
+            public bool generation_done = false;
+            public bool generation_failed = false;
+            public bool finished = false;
+        }
+
+        public ApiServer(ConfigManager config_manager, ModelManager model_manager) {
+            this.config_manager = config_manager;
+            this.model_manager = model_manager;
+        }
+
+        /**
+         * Démarre le serveur si la configuration l'active
+         */
+        public void start_if_enabled() {
+            if (config_manager.get_boolean("Server", "enabled", false)) {
+                start();
+            }
+        }
+
+        /**
+         * Démarre l'écoute sur l'interface de bouclage uniquement
+         */
+        public bool start() {
+            if (server != null) {
+                return true;
+            }
+
+            int port = config_manager.get_integer("Server", "port", DEFAULT_PORT);
+            server = new Soup.Server("server-header", "Sambo");
+            server.add_handler("/v1/models", handle_models);
+            server.add_handler("/v1/completions", (srv, msg, path, query) => {
+                handle_generation(msg, false);
+            });
+            server.add_handler("/v1/chat/completions", (srv, msg, path, query) => {
+                handle_generation(msg, true);
+            });
+
+            try {
+                server.listen_local((uint) port, Soup.ServerListenOptions.IPV4_ONLY);
+            } catch (Error e) {
+                warning("Impossible de démarrer le serveur local sur le port %d: %s", port, e.message);
+                server = null;
+                return false;
+            }
+
+            stderr.printf("[PERF] APISERVER: En écoute sur http://127.0.0.1:%d/v1\n", port);
+            return true;
+        }
+
+        /**
+         * Arrête le serveur et annule les générations en cours
+         */
+        public void stop() {
+            if (server == null) {
+                return;
+            }
+            foreach (var request in active_requests) {
+                request.cancellable.cancel();
+            }
+            server.disconnect();
+            server = null;
+            stderr.printf("[PERF] APISERVER: Arrêté\n");
+        }
+
+        public bool is_running() {
+            return server != null;
+        }
+
+        private void handle_models(Soup.Server srv, Soup.ServerMessage msg, string path, HashTable<string, string>? query) {
+            var data = new Json.Array();
+            if (model_manager.is_model_ready()) {
+                var model = new Json.Object();
+                model.set_string_member("id", model_manager.get_current_model_name());
+                model.set_string_member("object", "model");
+                model.set_int_member("created", get_real_time() / 1000000);
+                model.set_string_member("owned_by", "sambo");
+                data.add_object_element(model);
+            }
+
+            var root = new Json.Object();
+            root.set_string_member("object", "list");
+            root.set_array_member("data", data);
+            send_json(msg, Soup.Status.OK, root);
+        }
+
+        private void handle_generation(Soup.ServerMessage msg, bool chat) {
+            if (msg.get_method() != "POST") {
+                send_error(msg, Soup.Status.METHOD_NOT_ALLOWED, "invalid_request_error", "Méthode non supportée");
+                return;
+            }
+
+            if (!model_manager.is_model_ready() || model_manager.is_in_simulation_mode()) {
+                send_error(msg, Soup.Status.SERVICE_UNAVAILABLE, "server_error", "Aucun modèle chargé");
+                return;
+            }
+
+            Json.Object body;
+            try {
+                body = parse_body(msg);
+            } catch (Error e) {
+                send_error(msg, Soup.Status.BAD_REQUEST, "invalid_request_error", e.message);
+                return;
+            }
+
+            var profile = config_manager.get_selected_profile();
+            string prompt;
+            if (chat) {
+                if (!body.has_member("messages") || body.get_member("messages").get_node_type() != Json.NodeType.ARRAY) {
+                    send_error(msg, Soup.Status.BAD_REQUEST, "invalid_request_error", "Champ 'messages' requis");
+                    return;
+                }
+                prompt = build_chat_prompt(body.get_array_member("messages"), profile);
+            } else {
+                if (!body.has_member("prompt")) {
+                    send_error(msg, Soup.Status.BAD_REQUEST, "invalid_request_error", "Champ 'prompt' requis");
+                    return;
+                }
+                prompt = body.get_string_member("prompt") ?? "";
+            }
+
+            var params = build_sampling_params(body, profile);
+
+            var request = new ApiRequest();
+            request.msg = msg;
+            request.id = "%s-sambo-%u".printf(chat ? "chatcmpl" : "cmpl", ++request_counter);
+            request.model_name = model_manager.get_current_model_name();
+            request.created = get_real_time() / 1000000;
+            request.chat = chat;
+            request.stream = params.stream;
+            request.max_tokens = params.max_tokens;
+            request.start_time = get_monotonic_time();
+            active_requests.add(request);
+
+            // Le client qui se déconnecte annule sa génération
+            msg.disconnected.connect(() => {
+                request.cancellable.cancel();
+            });
+
+            if (request.stream) {
+                var headers = msg.get_response_headers();
+                headers.set_content_type("text/event-stream", null);
+                headers.set_encoding(Soup.Encoding.CHUNKED);
+                headers.replace("Cache-Control", "no-cache");
+                msg.set_status(Soup.Status.OK, null);
+            }
+            msg.pause();
+
+            Gee.List<LoraAdapter>? adapters = profile != null ? profile.lora_adapters : null;
+            string client = API_CLIENT_PREFIX;
+            if (body.has_member("user")) {
+                client = "%s:%s".printf(API_CLIENT_PREFIX, body.get_string_member("user") ?? "");
+            }
+
+            new Thread<void*>("api_generation", () => {
+                bool success = model_manager.generate_for_client(client, prompt, params, (token) => {
+                    request.mutex.lock();
+                    request.pending.append(token);
+                    request.token_count++;
+                    schedule_flush(request);
+                    request.mutex.unlock();
+                    return !request.cancellable.is_cancelled();
+                }, request.cancellable, adapters);
+
+                request.mutex.lock();
+                request.generation_done = true;
+                request.generation_failed = !success;
+                schedule_flush(request);
+                request.mutex.unlock();
+                return null;
+            });
+        }
+
+        /**
+         * Planifie l'envoi des tokens accumulés (appelée sous verrou)
+         *
+         * Les tokens sont regroupés sur FLUSH_INTERVAL_MS pour limiter le
+         * nombre de chunks HTTP et de réveils de la boucle principale.
+         */
+        private void schedule_flush(ApiRequest request) {
+            if (request.flush_scheduled) {
+                return;
+            }
+            request.flush_scheduled = true;
+            uint delay = request.generation_done ? 0 : FLUSH_INTERVAL_MS;
+            Timeout.add(delay, () => {
+                flush_request(request);
+                return Source.REMOVE;
+            });
+        }
+
+        private void flush_request(ApiRequest request) {
+            request.mutex.lock();
+            string text = request.pending.str;
+            request.pending.truncate(0);
+            request.full_text.append(text);
+            request.flush_scheduled = false;
+            bool done = request.generation_done;
+            bool failed = request.generation_failed;
+            int token_count = request.token_count;
+            request.mutex.unlock();
+
+            if (request.finished) {
+                return;
+            }
+
+            if (request.cancellable.is_cancelled()) {
+                if (done) {
+                    finish_request(request, "annulée");
+                }
+                return;
+            }
+
+            string finish_reason = token_count >= request.max_tokens ? "length" : "stop";
+
+            if (request.stream) {
+                var body = request.msg.get_response_body();
+                if (text.length > 0) {
+                    append_event(body, build_chunk(request, text, null));
+                }
+                if (done) {
+                    if (!failed) {
+                        append_event(body, build_chunk(request, "", finish_reason));
+                    }
+                    body.append_bytes(new Bytes("data: [DONE]\n\n".data));
+                    body.complete();
+                }
+                request.msg.unpause();
+            } else if (done) {
+                if (failed && request.full_text.len == 0) {
+                    send_error(request.msg, Soup.Status.INTERNAL_SERVER_ERROR, "server_error", "Échec de la génération");
+                } else {
+                    send_json(request.msg, Soup.Status.OK, build_response(request, finish_reason, token_count));
+                }
+                request.msg.unpause();
+            }
+
+            if (done) {
+                finish_request(request, failed ? "échouée" : "terminée");
+            }
+        }
+
+        private void finish_request(ApiRequest request, string outcome) {
+            request.finished = true;
+            active_requests.remove(request);
+
+            double elapsed_ms = (get_monotonic_time() - request.start_time) / 1000.0;
+            stderr.printf("[PERF] APISERVER: %s %s - %d tokens en %.1f ms (%.1f tokens/s)\n",
+                request.id, outcome, request.token_count, elapsed_ms,
+                elapsed_ms > 0 ? request.token_count * 1000.0 / elapsed_ms : 0.0);
+        }
+
+        private Json.Object build_chunk(ApiRequest request, string text, string? finish_reason) {
+            var choice = new Json.Object();
+            choice.set_int_member("index", 0);
+            if (request.chat) {
+                var delta = new Json.Object();
+                if (text.length > 0) {
+                    delta.set_string_member("content", text);
+                }
+                choice.set_object_member("delta", delta);
+            } else {
+                choice.set_string_member("text", text);
+            }
+            if (finish_reason != null) {
+                choice.set_string_member("finish_reason", finish_reason);
+            } else {
+                choice.set_null_member("finish_reason");
+            }
+
+            var root = create_envelope(request, request.chat ? "chat.completion.chunk" : "text_completion");
+            var choices = new Json.Array();
+            choices.add_object_element(choice);
+            root.set_array_member("choices", choices);
+            return root;
+        }
+
+        private Json.Object build_response(ApiRequest request, string finish_reason, int token_count) {
+            var choice = new Json.Object();
+            choice.set_int_member("index", 0);
+            if (request.chat) {
+                var message = new Json.Object();
+                message.set_string_member("role", "assistant");
+                message.set_string_member("content", request.full_text.str);
+                choice.set_object_member("message", message);
+            } else {
+                choice.set_string_member("text", request.full_text.str);
+            }
+            choice.set_string_member("finish_reason", finish_reason);
+
+            var root = create_envelope(request, request.chat ? "chat.completion" : "text_completion");
+            var choices = new Json.Array();
+            choices.add_object_element(choice);
+            root.set_array_member("choices", choices);
+
+            var usage = new Json.Object();
+            usage.set_int_member("completion_tokens", token_count);
+            root.set_object_member("usage", usage);
+            return root;
+        }
+
+        private Json.Object create_envelope(ApiRequest request, string object_type) {
+            var root = new Json.Object();
+            root.set_string_member("id", request.id);
+            root.set_string_member("object", object_type);
+            root.set_int_member("created", request.created);
+            root.set_string_member("model", request.model_name);
+            return root;
+        }
+
+        /**
+         * Construit le prompt de chat avec le template du profil, ou le format Llama 3 par défaut
+         */
+        private string build_chat_prompt(Json.Array messages, InferenceProfile? profile) {
+            string system_prompt = profile != null ? profile.prompt : "";
+            var turns = new Gee.ArrayList<Json.Object>();
+
+            messages.foreach_element((array, index, node) => {
+                if (node.get_node_type() != Json.NodeType.OBJECT) {
+                    return;
+                }
+                var message = node.get_object();
+                if (message.get_string_member_with_default("role", "") == "system") {
+                    system_prompt = message.get_string_member_with_default("content", "");
+                } else {
+                    turns.add(message);
+                }
+            });
+
+            var prompt = new StringBuilder();
+            if (profile != null && profile.template != null && profile.template.strip() != "") {
+                // Les templates de profil ne décrivent qu'un échange : l'historique est replié dans {user}
+                var history = new StringBuilder();
+                string last_user = "";
+                for (int i = 0; i < turns.size; i++) {
+                    string role = turns[i].get_string_member_with_default("role", "user");
+                    string content = turns[i].get_string_member_with_default("content", "");
+                    if (i == turns.size - 1 && role == "user") {
+                        last_user = content;
+                    } else {
+                        history.append("%s: %s\n\n".printf(role, content));
+                    }
+                }
+                string template_text = profile.template;
+                template_text = template_text.replace("{system}", system_prompt);
+                template_text = template_text.replace("{user}", history.str + last_user);
+                template_text = template_text.replace("{assistant}", "");
+                prompt.append(template_text);
+            } else {
+                prompt.append("<|begin_of_text|><|start_header_id|>system<|end_header_id|>\n\n");
+                prompt.append(system_prompt);
+                prompt.append("<|eot_id|>");
+                foreach (var message in turns) {
+                    prompt.append("<|start_header_id|>%s<|end_header_id|>\n\n".printf(
+                        message.get_string_member_with_default("role", "user")));
+                    prompt.append(message.get_string_member_with_default("content", ""));
+                    prompt.append("<|eot_id|>");
+                }
+                prompt.append("<|start_header_id|>assistant<|end_header_id|>\n\n");
+            }
+            return prompt.str;
+        }
+
+        /**
+         * Paramètres du profil sélectionné, surchargés par ceux de la requête
+         */
+        private Llama.SamplingParams build_sampling_params(Json.Object body, InferenceProfile? profile) {
+            Llama.SamplingParams params = {
+                profile != null ? profile.temperature : 0.7f,
+                profile != null ? profile.top_p : 0.9f,
+                profile != null ? profile.top_k : 40,
+                profile != null ? profile.max_tokens : 512,
+                profile != null ? profile.repetition_penalty : 1.1f,
+                profile != null ? profile.frequency_penalty : 0.0f,
+                profile != null ? profile.presence_penalty : 0.0f,
+                profile != null ? profile.seed : -1,
+                profile != null ? profile.context_length : 2048,
+                false,
+                profile != null ? profile.get_kv_cache_type() : Llama.KvCacheType.F16,
+                profile != null && profile.flash_attention
+            };
+
+            if (body.has_member("temperature")) params.temperature = (float) body.get_double_member("temperature");
+            if (body.has_member("top_p")) params.top_p = (float) body.get_double_member("top_p");
+            if (body.has_member("top_k")) params.top_k = (int) body.get_int_member("top_k");
+            if (body.has_member("max_tokens")) params.max_tokens = (int) body.get_int_member("max_tokens");
+            if (body.has_member("frequency_penalty")) params.frequency_penalty = (float) body.get_double_member("frequency_penalty");
+            if (body.has_member("presence_penalty")) params.presence_penalty = (float) body.get_double_member("presence_penalty");
+            if (body.has_member("seed")) params.seed = (int) body.get_int_member("seed");
+            if (body.has_member("stream")) params.stream = body.get_boolean_member("stream");
+            return params;
+        }
+
+        private Json.Object parse_body(Soup.ServerMessage msg) throws Error {
+            var bytes = msg.get_request_body().flatten();
+            unowned uint8[] data = bytes.get_data();
+            var parser = new Json.Parser();
+            parser.load_from_data((string) data, data.length);
+
+            var root = parser.get_root();
+            if (root == null || root.get_node_type() != Json.NodeType.OBJECT) {
+                throw new Error(Quark.from_string("ApiServerError"), 1, "Corps JSON invalide, objet attendu");
+            }
+            return root.get_object();
+        }
+
+        private void append_event(Soup.MessageBody body, Json.Object payload) {
+            body.append_bytes(new Bytes(("data: %s\n\n".printf(to_json_string(payload))).data));
+        }
+
+        private void send_error(Soup.ServerMessage msg, uint status, string type, string message) {
+            var error = new Json.Object();
+            error.set_string_member("message", message);
+            error.set_string_member("type", type);
+            var root = new Json.Object();
+            root.set_object_member("error", error);
+            send_json(msg, status, root);
+        }
+
+        private void send_json(Soup.ServerMessage msg, uint status, Json.Object root) {
+            msg.set_status(status, null);
+            msg.set_response("application/json", Soup.MemoryUse.COPY, to_json_string(root).data);
+        }
+
+        private static string to_json_string(Json.Object obj) {
+            var node = new Json.Node(Json.NodeType.OBJECT);
+            node.set_object(obj);
+            var generator = new Json.Generator();
+            generator.set_root(node);
+            return generator.to_data(null);
+        }
+    }
+}
@@ -6,6 +6,15 @@ namespace Sambo {
         // Gestionnaire de modèles IA
         public ModelManager model_manager;
 
+        // Libération du modèle sous pression mémoire ou après inactivité
+        public ResidencyManager residency;
+
+        // Serveur local compatible OpenAI (désactivé par défaut)
+        public ApiServer api_server;
+
+        // File des traitements par lot
+        public BatchJobManager batch_jobs;
+
         // Structures pour stocker les données des trois zones
         public ExplorerModel explorer;
         public EditorModel editor;
@@ -14,6 +23,10 @@ namespace Sambo {
         public ApplicationModel(ApplicationController controller) {
             config_manager = new ConfigManager();
             model_manager = new ModelManager();
+            residency = new ResidencyManager(config_manager, model_manager);
+            api_server = new ApiServer(config_manager, model_manager);
+            api_server.start_if_enabled();
+            batch_jobs = new BatchJobManager(config_manager, model_manager);
             explorer = new ExplorerModel(controller);
             editor = new EditorModel();
             communication = new CommunicationModel();
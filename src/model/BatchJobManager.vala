@@ -0,0 +1,741 @@
+namespace Sambo {
+    /**
+     * État d'un traitement par lot
+     */
+    public enum BatchJobState {
+        QUEUED,
+        RUNNING,
+        PAUSED,
+        COMPLETED,
+        CANCELLED;
+
+        public string to_label() {
+            switch (this) {
+                case QUEUED: return "En attente";
+                case RUNNING: return "En cours";
+                case PAUSED: return "En pause";
+                case COMPLETED: return "Terminé";
+                case CANCELLED: return "Annulé";
+                default: return "";
+            }
+        }
+    }
+
+    /**
+     * Traitement par lot : une même consigne appliquée à une liste de fichiers
+     *
+     * La sortie de chaque fichier est écrite à côté de l'original, avec
+     * output_suffix ajouté au nom. Les compteurs sont mis à jour depuis les
+     * threads du pipeline et lus depuis le thread principal.
+     */
+    public class BatchJob : Object {
+        public string id { get; construct; }
+        public string profile_id { get; construct; }
+        public string instruction { get; construct; }
+        public string output_suffix { get; construct; }
+        public Gee.ArrayList<string> files { get; construct; }
+
+        public BatchJobState state { get; set; default = BatchJobState.QUEUED; }
+        public string? last_error { get; set; default = null; }
+
+        // Chemins déjà traités (chargés depuis le point de reprise)
+        internal Gee.HashSet<string> done_paths = new Gee.HashSet<string>();
+
+        internal int completed_count = 0;
+        internal int failed_count = 0;
+        internal int truncated_count = 0;
+        internal int token_count = 0;
+        internal int64 run_time_us = 0;
+        internal int64 run_started_at = 0;
+        internal int session_completed = 0;
+        internal Cancellable? cancellable = null;
+
+        public BatchJob(string id, string profile_id, string instruction, string output_suffix, Gee.ArrayList<string> files) {
+            Object(id: id, profile_id: profile_id, instruction: instruction, output_suffix: output_suffix, files: files);
+        }
+
+        public int get_total() {
+            return files.size;
+        }
+
+        public int get_completed() {
+            return AtomicInt.get(ref completed_count);
+        }
+
+        public int get_failed() {
+            return AtomicInt.get(ref failed_count);
+        }
+
+        /**
+         * Nombre de fichiers dont seul le début a été soumis au modèle
+         */
+        public int get_truncated() {
+            return AtomicInt.get(ref truncated_count);
+        }
+
+        public double get_progress() {
+            return files.size == 0 ? 1.0 : (double) get_completed() / files.size;
+        }
+
+        /**
+         * Durée de traitement cumulée en secondes, session en cours comprise
+         */
+        public double get_elapsed_seconds() {
+            int64 total = run_time_us;
+            if (run_started_at > 0) {
+                total += get_monotonic_time() - run_started_at;
+            }
+            return total / 1000000.0;
+        }
+
+        public double get_tokens_per_second() {
+            double elapsed = get_elapsed_seconds();
+            return elapsed > 0 ? AtomicInt.get(ref token_count) / elapsed : 0.0;
+        }
+
+        public double get_files_per_minute() {
+            double elapsed = get_elapsed_seconds();
+            return elapsed > 0 ? AtomicInt.get(ref session_completed) * 60.0 / elapsed : 0.0;
+        }
+    }
+
+    /**
+     * File de traitements par lot sur le modèle local
+     *
+     * Chaque traitement tourne en pipeline sur trois threads : lecture
+     * anticipée des fichiers, génération, écriture des résultats. Le modèle
+     * n'attend ainsi jamais une entrée/sortie disque entre deux fichiers. La
+     * consigne est placée avant le contenu du fichier dans le prompt, si bien
+     * que le préfixe commun (prompt système du profil et consigne) reste dans
+     * le cache KV d'un fichier à l'autre.
+     *
+     * Un point de reprise est tenu dans ~/.config/sambo/batch : description du
+     * traitement (<id>.json) et journal en ajout seul des fichiers terminés
+     * (<id>.done). Un traitement interrompu est rechargé en pause au démarrage.
+     *
+     * Le gestionnaire ne charge jamais de modèle lui-même : un traitement
+     * attend en file que le modèle de son profil soit celui du chat, et
+     * retourne en file si le chat en charge un autre pendant l'exécution.
+     */
+    public class BatchJobManager : Object {
+        private const string CLIENT_ID = "batch";
+        private const int READ_AHEAD = 8;
+        private const int WRITE_BEHIND = 32;
+        // Lecture bornée avant le décompte exact : aucun token ne dépasse cette taille
+        private const int MAX_BYTES_PER_TOKEN = 16;
+        // Tokens fusionnés aux jonctions du prompt et token de début de texte
+        private const int PROMPT_MARGIN_TOKENS = 16;
+        private const uint PROGRESS_INTERVAL_MS = 250;
+
+        private ConfigManager config_manager;
+        private ModelManager model_manager;
+        private string checkpoint_dir;
+        private Gee.ArrayList<BatchJob> jobs = new Gee.ArrayList<BatchJob>();
+        private BatchJob? running_job = null;
+        private uint progress_timeout_id = 0;
+
+        /**
+         * Émis quand un traitement est ajouté à la liste
+         */
+        public signal void job_added(BatchJob job);
+
+        /**
+         * Émis sur le thread principal quand l'état d'un traitement change
+         */
+        public signal void job_state_changed(BatchJob job);
+
+        /**
+         * Émis périodiquement sur le thread principal pendant l'exécution
+         */
+        public signal void job_progress(BatchJob job);
+
+        private class BatchItem {
+            public string path;
+            public string? content;
+            public string? output;
+            public string? error;
+            public int64 input_size;
+            public bool truncated;
+        }
+
+        /**
+         * File bornée entre deux étages du pipeline
+         */
+        private class PipelineQueue {
+            private Mutex mutex = Mutex();
+            private Cond cond = Cond();
+            private Gee.LinkedList<BatchItem> items = new Gee.LinkedList<BatchItem>();
+            private int capacity;
+            private bool closed = false;
+
+            public PipelineQueue(int capacity) {
+                this.capacity = capacity;
+            }
+
+            public void push(BatchItem item) {
+                mutex.lock();
+                while (items.size >= capacity && !closed) {
+                    cond.wait(mutex);
+                }
+                if (!closed) {
+                    items.add(item);
+                    cond.broadcast();
+                }
+                mutex.unlock();
+            }
+
+            /**
+             * @return null quand la file est fermée et vide
+             */
+            public BatchItem? pop() {
+                mutex.lock();
+                while (items.is_empty && !closed) {
+                    cond.wait(mutex);
+                }
+                BatchItem? item = items.is_empty ? null : items.poll_head();
+                cond.broadcast();
+                mutex.unlock();
+                return item;
+            }
+
+            public void close() {
+                mutex.lock();
+                closed = true;
+                cond.broadcast();
+                mutex.unlock();
+            }
+        }
+
+        public BatchJobManager(ConfigManager config_manager, ModelManager model_manager) {
+            this.config_manager = config_manager;
+            this.model_manager = model_manager;
+            checkpoint_dir = Path.build_filename(Environment.get_user_config_dir(), "sambo", "batch");
+            DirUtils.create_with_parents(checkpoint_dir, 0755);
+            load_checkpoints();
+
+            model_manager.model_changing.connect(on_model_changing);
+            model_manager.model_loaded.connect((model_path, model_name) => {
+                schedule_next();
+            });
+        }
+
+        public Gee.List<BatchJob> get_jobs() {
+            return jobs.read_only_view;
+        }
+
+        /**
+         * Crée un traitement et le place en file d'attente
+         */
+        public BatchJob submit(InferenceProfile profile, string instruction, Gee.List<string> paths, string output_suffix) {
+            var files = new Gee.ArrayList<string>();
+            files.add_all(paths);
+            string id = "%s-%u".printf(new DateTime.now_local().format("%Y%m%d-%H%M%S"), Random.next_int() % 10000);
+            var job = new BatchJob(id, profile.id, instruction, output_suffix, files);
+
+            save_job_description(job);
+            jobs.add(job);
+            job_added(job);
+
+            stderr.printf("[PERF] BATCHJOB: Traitement %s créé (%d fichiers, profil %s)\n",
+                id, files.size, profile.title);
+            schedule_next();
+            return job;
+        }
+
+        /**
+         * Met un traitement en pause ; le fichier en cours sera repris depuis le début
+         */
+        public void pause(BatchJob job) {
+            if (job.state == BatchJobState.RUNNING && job.cancellable != null) {
+                job.state = BatchJobState.PAUSED;
+                job.cancellable.cancel();
+            } else if (job.state == BatchJobState.QUEUED) {
+                job.last_error = null;
+                set_state(job, BatchJobState.PAUSED);
+            }
+        }
+
+        /**
+         * Reprend un traitement en pause là où il s'était arrêté
+         */
+        public void resume(BatchJob job) {
+            if (job.state == BatchJobState.PAUSED) {
+                job.last_error = null;
+                set_state(job, BatchJobState.QUEUED);
+                schedule_next();
+            }
+        }
+
+        /**
+         * Annule définitivement un traitement et supprime son point de reprise
+         */
+        public void cancel(BatchJob job) {
+            bool was_running = job.state == BatchJobState.RUNNING;
+            job.state = BatchJobState.CANCELLED;
+            if (was_running && job.cancellable != null) {
+                job.cancellable.cancel();
+            } else {
+                delete_checkpoint(job);
+                job_state_changed(job);
+            }
+        }
+
+        private void set_state(BatchJob job, BatchJobState state) {
+            job.state = state;
+            job_state_changed(job);
+        }
+
+        /**
+         * Démarre le prochain traitement en attente si aucun ne tourne
+         *
+         * Seuls les traitements dont le modèle est déjà chargé peuvent
+         * démarrer ; les autres restent en file jusqu'au prochain model_loaded.
+         */
+        private void schedule_next() {
+            if (running_job != null) {
+                return;
+            }
+
+            foreach (var job in jobs) {
+                if (job.state != BatchJobState.QUEUED) {
+                    continue;
+                }
+                var profile = config_manager.get_profile(job.profile_id);
+                if (profile == null) {
+                    job.last_error = "Profil introuvable : %s".printf(job.profile_id);
+                    set_state(job, BatchJobState.PAUSED);
+                    continue;
+                }
+                if (!is_profile_model_resident(profile)) {
+                    string waiting = "En attente du modèle %s".printf(Path.get_basename(profile.model_path));
+                    if (job.last_error != waiting) {
+                        job.last_error = waiting;
+                        job_state_changed(job);
+                    }
+                    continue;
+                }
+                start_job(job, profile);
+                return;
+            }
+        }
+
+        private bool is_profile_model_resident(InferenceProfile profile) {
+            return model_manager.is_model_ready() && !model_manager.is_in_simulation_mode() &&
+                   model_manager.get_current_model_path() == profile.model_path;
+        }
+
+        /**
+         * Le chat va remplacer le modèle : le traitement en cours retourne en
+         * file avant le chargement, le fichier en cours sera repris
+         */
+        private void on_model_changing(string model_path) {
+            if (running_job == null || running_job.cancellable == null) {
+                return;
+            }
+            var profile = config_manager.get_profile(running_job.profile_id);
+            if (profile != null && profile.model_path == model_path) {
+                return;
+            }
+
+            stderr.printf("[PERF] BATCHJOB: %s remis en file, le modèle %s remplace celui du traitement\n",
+                running_job.id, Path.get_basename(model_path));
+            running_job.state = BatchJobState.QUEUED;
+            running_job.cancellable.cancel();
+        }
+
+        private void start_job(BatchJob job, InferenceProfile profile) {
+            job.last_error = null;
+
+            Llama.SamplingParams params = {
+                profile.temperature,
+                profile.top_p,
+                profile.top_k,
+                profile.max_tokens,
+                profile.repetition_penalty,
+                profile.frequency_penalty,
+                profile.presence_penalty,
+                profile.seed,
+                profile.context_length,
+                false,
+                profile.get_kv_cache_type(),
+                profile.flash_attention
+            };
+            string prompt_prefix;
+            string prompt_suffix;
+            build_prompt_parts(profile, job.instruction, out prompt_prefix, out prompt_suffix);
+            var adapters = profile.lora_adapters;
+
+            running_job = job;
+            job.cancellable = new Cancellable();
+            job.run_started_at = get_monotonic_time();
+            AtomicInt.set(ref job.session_completed, 0);
+            set_state(job, BatchJobState.RUNNING);
+
+            progress_timeout_id = Timeout.add(PROGRESS_INTERVAL_MS, () => {
+                if (running_job != null) {
+                    job_progress(running_job);
+                }
+                return Source.CONTINUE;
+            });
+
+            stderr.printf("[PERF] BATCHJOB: Démarrage de %s (%d/%d déjà traités)\n",
+                job.id, job.get_completed(), job.get_total());
+
+            new Thread<void*>("batch_job", () => {
+                string? error = run_pipeline(job, prompt_prefix, prompt_suffix, params, adapters);
+                Idle.add(() => {
+                    if (error != null) {
+                        job.last_error = error;
+                    }
+                    on_job_finished(job);
+                    return Source.REMOVE;
+                });
+                return null;
+            });
+        }
+
+        /**
+         * Pipeline lecture → génération → écriture (thread de traitement)
+         *
+         * Le contenu de chaque fichier est tronqué, dès la lecture, au nombre
+         * de tokens que le contexte laisse après la consigne et la réponse.
+         * @return un message d'erreur si le traitement ne peut pas démarrer
+         */
+        private string? run_pipeline(BatchJob job, string prompt_prefix, string prompt_suffix, Llama.SamplingParams params,
+                                     Gee.List<LoraAdapter> adapters) {
+            int prompt_tokens = model_manager.count_tokens(prompt_prefix + prompt_suffix);
+            int max_input_tokens = params.context_length - params.max_tokens - prompt_tokens - PROMPT_MARGIN_TOKENS;
+            if (max_input_tokens <= 0) {
+                warning("Traitement par lot %s: contexte de %d tokens insuffisant (consigne %d, réponse %d)",
+                    job.id, params.context_length, prompt_tokens, params.max_tokens);
+                return "Contexte trop petit pour la consigne et la réponse";
+            }
+            int64 max_input_bytes = (int64) max_input_tokens * MAX_BYTES_PER_TOKEN;
+
+            var input_queue = new PipelineQueue(READ_AHEAD);
+            var output_queue = new PipelineQueue(WRITE_BEHIND);
+            var cancellable = job.cancellable;
+
+            var reader = new Thread<void*>("batch_reader", () => {
+                foreach (var path in job.files) {
+                    if (cancellable.is_cancelled()) {
+                        break;
+                    }
+                    if (job.done_paths.contains(path)) {
+                        continue;
+                    }
+                    var item = new BatchItem();
+                    item.path = path;
+                    try {
+                        item.content = read_input(path, max_input_bytes, cancellable, out item.input_size);
+                        item.truncated = item.input_size > item.content.length;
+                        if (truncate_to_tokens(ref item.content, max_input_tokens)) {
+                            item.truncated = true;
+                        }
+                    } catch (Error e) {
+                        item.error = e.message;
+                    }
+                    input_queue.push(item);
+                }
+                input_queue.close();
+                return null;
+            });
+
+            var writer = new Thread<void*>("batch_writer", () => {
+                FileOutputStream? journal = open_journal(job);
+                BatchItem? item;
+                while ((item = output_queue.pop()) != null) {
+                    bool ok = item.error == null;
+                    if (ok) {
+                        try {
+                            if (item.truncated) {
+                                item.output += "\n\n[Entrée tronquée : %s traités sur %s]\n".printf(
+                                    format_size((uint64) item.content.length), format_size((uint64) item.input_size));
+                            }
+                            FileUtils.set_contents(item.path + job.output_suffix, item.output);
+                        } catch (Error e) {
+                            item.error = e.message;
+                            ok = false;
+                        }
+                    }
+                    if (!ok) {
+                        warning("Traitement par lot %s, échec pour %s: %s", job.id, item.path, item.error);
+                        AtomicInt.inc(ref job.failed_count);
+                    } else if (item.truncated) {
+                        warning("Traitement par lot %s, %s tronqué à %s", job.id, item.path,
+                            format_size((uint64) item.content.length));
+                        AtomicInt.inc(ref job.truncated_count);
+                    }
+                    AtomicInt.inc(ref job.completed_count);
+                    AtomicInt.inc(ref job.session_completed);
+
+                    if (journal != null) {
+                        try {
+                            string status = !ok ? "err" : (item.truncated ? "cut" : "ok");
+                            journal.write_all("%s\t%s\n".printf(status, item.path).data, null);
+                            journal.flush();
+                        } catch (Error e) {
+                            warning("Impossible d'écrire le point de reprise: %s", e.message);
+                        }
+                    }
+                }
+                if (journal != null) {
+                    try {
+                        journal.close();
+                    } catch (Error e) {
+                    }
+                }
+                return null;
+            });
+
+            BatchItem? item;
+            while ((item = input_queue.pop()) != null) {
+                if (cancellable.is_cancelled()) {
+                    continue;
+                }
+                if (item.error == null) {
+                    var output = new StringBuilder();
+                    int tokens = 0;
+                    string prompt = prompt_prefix + item.content + prompt_suffix;
+                    bool success = model_manager.generate_for_client(CLIENT_ID, prompt, params, (token) => {
+                        output.append(token);
+                        tokens++;
+                        return true;
+                    }, cancellable, adapters);
+                    AtomicInt.add(ref job.token_count, tokens);
+                    if (cancellable.is_cancelled()) {
+                        // Sortie incomplète : ni écrite ni marquée comme faite
+                        continue;
+                    }
+                    if (success) {
+                        item.output = output.str;
+                    } else {
+                        item.error = "échec de la génération";
+                    }
+                }
+                output_queue.push(item);
+            }
+
+            // Le lecteur peut être bloqué sur une file pleine après une annulation
+            input_queue.close();
+            output_queue.close();
+            reader.join();
+            writer.join();
+            return null;
+        }
+
+        /**
+         * Coupe un texte à max_tokens tokens au plus, sur une frontière UTF-8
+         * @return true si le texte a été coupé
+         */
+        private bool truncate_to_tokens(ref string text, int max_tokens) {
+            int tokens = model_manager.count_tokens(text);
+            if (tokens <= max_tokens) {
+                return false;
+            }
+            while (tokens > max_tokens && text.length > 0) {
+                // Rapport octets/token du texte, avec 5 % de marge
+                long length = (long) (text.length * ((double) max_tokens / tokens) * 0.95);
+                while (length > 0 && ((uchar) text[length] & 0xC0) == 0x80) {
+                    length--;
+                }
+                text = text.substring(0, length);
+                tokens = model_manager.count_tokens(text);
+            }
+            return true;
+        }
+
+        private void on_job_finished(BatchJob job) {
+            if (progress_timeout_id != 0) {
+                Source.remove(progress_timeout_id);
+                progress_timeout_id = 0;
+            }
+            job.run_time_us += get_monotonic_time() - job.run_started_at;
+            job.run_started_at = 0;
+            job.cancellable = null;
+            running_job = null;
+
+            stderr.printf("[PERF] BATCHJOB: %s arrêté - %d/%d fichiers (%d échecs, %d tronqués), %.1f tokens/s, %.1f fichiers/min\n",
+                job.id, job.get_completed(), job.get_total(), job.get_failed(), job.get_truncated(),
+                job.get_tokens_per_second(), job.get_files_per_minute());
+
+            if (job.state == BatchJobState.CANCELLED) {
+                delete_checkpoint(job);
+            } else if (job.state == BatchJobState.RUNNING) {
+                job.state = job.get_completed() >= job.get_total() ? BatchJobState.COMPLETED : BatchJobState.PAUSED;
+                if (job.state == BatchJobState.COMPLETED) {
+                    delete_checkpoint(job);
+                }
+            }
+
+            job_progress(job);
+            job_state_changed(job);
+            schedule_next();
+        }
+
+        /**
+         * Découpe le prompt autour du contenu du fichier, avec le template du
+         * profil ou le format Llama 3 par défaut. Le préfixe ne dépend que du
+         * profil et de la consigne, et reste commun à tous les fichiers.
+         */
+        private void build_prompt_parts(InferenceProfile profile, string instruction, out string prefix, out string suffix) {
+            const string CONTENT_MARKER = "\x01";
+            string user_message = instruction + "\n\n" + CONTENT_MARKER;
+            string full;
+
+            if (profile.template != null && profile.template.strip() != "") {
+                full = profile.template.replace("{system}", profile.prompt)
+                                       .replace("{user}", user_message)
+                                       .replace("{assistant}", "");
+            } else {
+                full = "<|begin_of_text|><|start_header_id|>system<|end_header_id|>\n\n" + profile.prompt +
+                       "<|eot_id|><|start_header_id|>user<|end_header_id|>\n\n" + user_message +
+                       "<|eot_id|><|start_header_id|>assistant<|end_header_id|>\n\n";
+            }
+
+            int marker = full.index_of(CONTENT_MARKER);
+            if (marker < 0) {
+                // Template sans {user} : le contenu est ajouté en fin de prompt
+                prefix = full + "\n\n";
+                suffix = "";
+            } else {
+                prefix = full.substring(0, marker);
+                suffix = full.substring(marker + CONTENT_MARKER.length);
+            }
+        }
+
+        /**
+         * Lit un fichier d'entrée, tronqué à max_bytes sur une frontière UTF-8
+         * @param size taille complète du fichier, supérieure à max_bytes s'il a été tronqué
+         */
+        private static string read_input(string path, int64 max_bytes, Cancellable cancellable, out int64 size) throws Error {
+            var stream = File.new_for_path(path).read(cancellable);
+            size = stream.query_info(FileAttribute.STANDARD_SIZE, cancellable).get_size();
+            var buffer = new uint8[max_bytes + 1];
+            size_t bytes_read;
+            stream.read_all(buffer[0:max_bytes], out bytes_read, cancellable);
+            stream.close();
+
+            buffer[bytes_read] = 0;
+            unowned string text = (string) buffer;
+            char* end;
+            if (!text.validate((ssize_t) bytes_read, out end)) {
+                size_t valid_length = (size_t) (end - (char*) text);
+                // Seul un caractère coupé par la troncature est toléré
+                if (bytes_read < max_bytes || valid_length + 4 < bytes_read) {
+                    throw new ConvertError.ILLEGAL_SEQUENCE("Fichier non UTF-8");
+                }
+                bytes_read = valid_length;
+            }
+            return text.substring(0, (long) bytes_read);
+        }
+
+        private string description_path(BatchJob job) {
+            return Path.build_filename(checkpoint_dir, job.id + ".json");
+        }
+
+        private string journal_path(BatchJob job) {
+            return Path.build_filename(checkpoint_dir, job.id + ".done");
+        }
+
+        private FileOutputStream? open_journal(BatchJob job) {
+            try {
+                return File.new_for_path(journal_path(job)).append_to(FileCreateFlags.NONE);
+            } catch (Error e) {
+                warning("Impossible d'ouvrir le point de reprise de %s: %s", job.id, e.message);
+                return null;
+            }
+        }
+
+        private void save_job_description(BatchJob job) {
+            var obj = new Json.Object();
+            obj.set_string_member("id", job.id);
+            obj.set_string_member("profile_id", job.profile_id);
+            obj.set_string_member("instruction", job.instruction);
+            obj.set_string_member("output_suffix", job.output_suffix);
+            var files = new Json.Array();
+            foreach (var path in job.files) {
+                files.add_string_element(path);
+            }
+            obj.set_array_member("files", files);
+
+            var node = new Json.Node(Json.NodeType.OBJECT);
+            node.set_object(obj);
+            var generator = new Json.Generator();
+            generator.set_root(node);
+            try {
+                FileUtils.set_contents(description_path(job), generator.to_data(null));
+            } catch (Error e) {
+                warning("Impossible d'enregistrer le traitement %s: %s", job.id, e.message);
+            }
+        }
+
+        private void delete_checkpoint(BatchJob job) {
+            FileUtils.unlink(description_path(job));
+            FileUtils.unlink(journal_path(job));
+        }
+
+        /**
+         * Recharge en pause les traitements interrompus lors d'une session précédente
+         */
+        private void load_checkpoints() {
+            try {
+                var dir = Dir.open(checkpoint_dir);
+                string? name;
+                while ((name = dir.read_name()) != null) {
+                    if (!name.has_suffix(".json")) {
+                        continue;
+                    }
+                    var job = load_job(Path.build_filename(checkpoint_dir, name));
+                    if (job != null) {
+                        job.state = BatchJobState.PAUSED;
+                        jobs.add(job);
+                        stderr.printf("[PERF] BATCHJOB: Traitement interrompu %s rechargé (%d/%d)\n",
+                            job.id, job.get_completed(), job.get_total());
+                    }
+                }
+            } catch (FileError e) {
+                warning("Impossible de lire les traitements par lot: %s", e.message);
+            }
+        }
+
+        private BatchJob? load_job(string path) {
+            try {
+                var parser = new Json.Parser();
+                parser.load_from_file(path);
+                var obj = parser.get_root().get_object();
+
+                var files = new Gee.ArrayList<string>();
+                obj.get_array_member("files").foreach_element((array, index, node) => {
+                    files.add(node.get_string());
+                });
+                var job = new BatchJob(
+                    obj.get_string_member("id"),
+                    obj.get_string_member("profile_id"),
+                    obj.get_string_member("instruction"),
+                    obj.get_string_member("output_suffix"),
+                    files);
+
+                string journal;
+                if (FileUtils.test(journal_path(job), FileTest.EXISTS) &&
+                    FileUtils.get_contents(journal_path(job), out journal)) {
+                    foreach (var line in journal.split("\n")) {
+                        var parts = line.split("\t", 2);
+                        if (parts.length == 2 && job.done_paths.add(parts[1])) {
+                            job.completed_count++;
+                            if (parts[0] == "err") {
+                                job.failed_count++;
+                            } else if (parts[0] == "cut") {
+                                job.truncated_count++;
+                            }
+                        }
+                    }
+                }
+                return job;
+            } catch (Error e) {
+                warning("Point de reprise invalide %s: %s", path, e.message);
+                return null;
+            }
+        }
+    }
+}
@@ -23,6 +23,9 @@ namespace Sambo {
         public bool is_processing_complete { get; set; default = false; }
         public DateTime? completion_time { get; set; default = null; } // Heure de fin de traitement
 
+        // Tokens du message, conservés dans l'historique persistant quand ils sont connus
+        public int[]? token_ids = null;
+
         /**
          * Crée un nouveau message
          */
@@ -119,6 +119,30 @@ namespace Sambo {
             key_file.set_boolean(group, key, value);
         }
 
+        public string[] get_string_list(string group, string key) {
+            try {
+                return key_file.get_string_list(group, key);
+            } catch (Error e) {
+                return {};
+            }
+        }
+
+        public void set_string_list(string group, string key, string[] values) {
+            key_file.set_string_list(group, key, values);
+        }
+
+        public double[] get_double_list(string group, string key) {
+            try {
+                return key_file.get_double_list(group, key);
+            } catch (Error e) {
+                return {};
+            }
+        }
+
+        public void set_double_list(string group, string key, double[] values) {
+            key_file.set_double_list(group, key, values);
+        }
+
         /**
          * Obtient le prompt système depuis la configuration
          * @return Le prompt système ou une valeur par défaut
@@ -419,6 +443,16 @@ namespace Sambo {
                 profile.seed = get_integer(group, "seed", -1);
                 profile.context_length = get_integer(group, "context_length", 2048);
                 profile.stream = get_boolean(group, "stream", true);
+                profile.kv_cache_type = get_string(group, "kv_cache_type", "f16");
+                profile.flash_attention = get_boolean(group, "flash_attention", false);
+
+                // Adaptateurs LoRA (échelle 1.0 si absente)
+                var lora_paths = get_string_list(group, "lora_adapters");
+                var lora_scales = get_double_list(group, "lora_scales");
+                for (int i = 0; i < lora_paths.length; i++) {
+                    float scale = i < lora_scales.length ? (float) lora_scales[i] : 1.0f;
+                    profile.lora_adapters.add(new LoraAdapter(lora_paths[i], scale));
+                }
 
                 return profile;
 
@@ -450,6 +484,18 @@ namespace Sambo {
             set_integer(group, "seed", profile.seed);
             set_integer(group, "context_length", profile.context_length);
             set_boolean(group, "stream", profile.stream);
+            set_string(group, "kv_cache_type", profile.kv_cache_type);
+            set_boolean(group, "flash_attention", profile.flash_attention);
+
+            // Adaptateurs LoRA
+            string[] lora_paths = {};
+            double[] lora_scales = {};
+            foreach (var adapter in profile.lora_adapters) {
+                lora_paths += adapter.path;
+                lora_scales += adapter.scale;
+            }
+            set_string_list(group, "lora_adapters", lora_paths);
+            set_double_list(group, "lora_scales", lora_scales);
 
             // Mettre à jour le cache
             profiles_cache.set(profile.id, profile);
@@ -0,0 +1,382 @@
+using GLib;
+using Gee;
+
+namespace Sambo {
+    /**
+     * Historique de conversation persistant
+     *
+     * Les messages sont écrits dans un journal binaire en ajout seul
+     * (~/.config/sambo/conversations/<id>.sambolog). À l'ouverture, seul un
+     * index des positions d'enregistrement est construit ; les messages sont
+     * relus à la demande quand la ListView réalise une ligne, avec un petit
+     * cache LRU. La mémoire reste ainsi bornée par la zone visible.
+     *
+     * Format : en-tête "SAMBOLOG" + version, puis des enregistrements
+     * [type:uint8][longueur:uint32][charge utile] en big-endian.
+     */
+    public class ConversationStore : Object, ListModel {
+        private const string LOG_MAGIC = "SAMBOLOG";
+        private const uint8 LOG_VERSION = 1;
+        private const uint8 RECORD_MESSAGE = 1;
+        private const int HEADER_SIZE = 9;               // Magic (8) + version (1)
+        private const int MAX_CACHED_MESSAGES = 128;      // Messages matérialisés gardés en mémoire
+
+        private string conversation_id;
+        private File log_file;
+        private FileInputStream? reader = null;
+        private FileOutputStream? writer = null;
+        private int64 log_size = 0;
+
+        // Index : position du message -> offset de son enregistrement dans le journal
+        private int64[] offsets = {};
+
+        // Cache LRU des messages relus depuis le disque
+        private HashMap<uint, ChatMessage> cache;
+        private Gee.LinkedList<uint> cache_order;
+
+        // Message en cours de génération, écrit seulement une fois terminé
+        private ChatMessage? live_message = null;
+
+        /**
+         * Ouvre (ou crée) la conversation identifiée par conversation_id
+         */
+        public ConversationStore(string conversation_id = "default") {
+            this.conversation_id = conversation_id;
+            cache = new HashMap<uint, ChatMessage>();
+            cache_order = new Gee.LinkedList<uint>();
+
+            string conversations_dir = get_conversations_dir();
+            log_file = File.new_for_path(Path.build_filename(conversations_dir, conversation_id + ".sambolog"));
+
+            try {
+                var dir = File.new_for_path(conversations_dir);
+                if (!dir.query_exists()) {
+                    dir.make_directory_with_parents();
+                }
+                open_log();
+            } catch (Error e) {
+                warning("Erreur lors de l'ouverture de la conversation %s: %s", conversation_id, e.message);
+            }
+        }
+
+        /**
+         * Répertoire contenant les journaux de conversation
+         */
+        public static string get_conversations_dir() {
+            return Path.build_filename(Environment.get_user_config_dir(), "sambo", "conversations");
+        }
+
+        // --- ListModel ---
+
+        public Type get_item_type() {
+            return typeof(ChatMessage);
+        }
+
+        public uint get_n_items() {
+            return offsets.length + (live_message != null ? 1 : 0);
+        }
+
+        public Object? get_item(uint position) {
+            if (position == offsets.length && live_message != null) {
+                return live_message;
+            }
+            if (position >= offsets.length) {
+                return null;
+            }
+
+            if (cache.has_key(position)) {
+                cache_order.remove(position);
+                cache_order.offer_head(position);
+                return cache[position];
+            }
+
+            ChatMessage? message = null;
+            try {
+                message = read_message_at(offsets[position]);
+            } catch (Error e) {
+                warning("Erreur de lecture du message %u: %s", position, e.message);
+                message = new ChatMessage("⚠️ Message illisible", ChatMessage.SenderType.AI);
+            }
+            remember(position, message);
+            return message;
+        }
+
+        // --- API publique ---
+
+        /**
+         * Ajoute un message terminé et l'écrit immédiatement dans le journal
+         */
+        public void append(ChatMessage message) {
+            // Pendant une génération, le nouveau message s'insère avant le message en cours
+            uint position = offsets.length;
+            try {
+                write_message(message);
+            } catch (Error e) {
+                warning("Erreur lors de l'écriture du message: %s", e.message);
+                return;
+            }
+            remember(position, message);
+            items_changed(position, 0, 1);
+        }
+
+        /**
+         * Ajoute un message en cours de génération (streaming)
+         *
+         * Le message reste en mémoire et n'est écrit qu'à l'appel de commit_live(),
+         * ce qui garde le journal en ajout seul.
+         */
+        public void append_live(ChatMessage message) {
+            if (live_message != null) {
+                commit_live();
+            }
+            live_message = message;
+            items_changed(offsets.length, 0, 1);
+        }
+
+        /**
+         * Écrit le message en cours dans le journal avec son contenu et ses statistiques finales
+         */
+        public void commit_live() {
+            if (live_message == null) {
+                return;
+            }
+
+            var message = live_message;
+            uint position = offsets.length;
+            try {
+                write_message(message);
+                live_message = null;
+                remember(position, message);
+            } catch (Error e) {
+                warning("Erreur lors de l'écriture du message en cours: %s", e.message);
+            }
+        }
+
+        /**
+         * Archive la conversation actuelle et en démarre une nouvelle
+         */
+        public void start_new_conversation() {
+            commit_live();
+            uint old_count = get_n_items();
+
+            close_streams();
+            try {
+                if (log_file.query_exists()) {
+                    string archive_name = "%s-%s.sambolog".printf(conversation_id,
+                        new DateTime.now_local().format("%Y%m%d-%H%M%S"));
+                    log_file.set_display_name(archive_name);
+                }
+            } catch (Error e) {
+                warning("Erreur lors de l'archivage de la conversation: %s", e.message);
+            }
+
+            offsets = {};
+            cache.clear();
+            cache_order.clear();
+            log_file = File.new_for_path(Path.build_filename(get_conversations_dir(), conversation_id + ".sambolog"));
+
+            try {
+                open_log();
+            } catch (Error e) {
+                warning("Erreur lors de la création de la conversation: %s", e.message);
+            }
+
+            if (old_count > 0) {
+                items_changed(0, old_count, 0);
+            }
+        }
+
+        /**
+         * Indique si la conversation ne contient aucun message
+         */
+        public bool is_empty() {
+            return get_n_items() == 0;
+        }
+
+        // --- Journal ---
+
+        /**
+         * Ouvre le journal et construit l'index en ne lisant que les en-têtes d'enregistrement
+         */
+        private void open_log() throws Error {
+            if (!log_file.query_exists()) {
+                var dos = new DataOutputStream(log_file.create(FileCreateFlags.PRIVATE));
+                dos.put_string(LOG_MAGIC);
+                dos.put_byte(LOG_VERSION);
+                dos.close();
+            }
+
+            var dis = new DataInputStream(log_file.read());
+            dis.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+
+            uint8[] magic = new uint8[LOG_MAGIC.length];
+            size_t magic_read;
+            dis.read_all(magic, out magic_read);
+            if (magic_read != LOG_MAGIC.length || Memory.cmp(magic, LOG_MAGIC.data, LOG_MAGIC.length) != 0) {
+                throw new IOError.INVALID_DATA("Journal de conversation invalide: %s", log_file.get_path());
+            }
+            uint8 version = dis.read_byte();
+            if (version > LOG_VERSION) {
+                throw new IOError.NOT_SUPPORTED("Version de journal non supportée: %u", version);
+            }
+
+            int64 offset = HEADER_SIZE;
+            int64 file_size = log_file.query_info(FileAttribute.STANDARD_SIZE, FileQueryInfoFlags.NONE).get_size();
+
+            while (offset + 5 <= file_size) {
+                uint8 record_type = dis.read_byte();
+                uint32 payload_size = dis.read_uint32();
+                if (offset + 5 + payload_size > file_size) {
+                    break; // Enregistrement tronqué (arrêt brutal pendant l'écriture)
+                }
+                if (record_type == RECORD_MESSAGE) {
+                    offsets += offset;
+                }
+                dis.skip(payload_size);
+                offset += 5 + payload_size;
+            }
+            dis.close();
+
+            // Supprimer une éventuelle fin tronquée pour que les ajouts restent lisibles
+            if (offset < file_size) {
+                stderr.printf("[WARNING] CONVERSATIONSTORE: Fin de journal tronquée ignorée (%lld octets)\n",
+                    file_size - offset);
+                var io = log_file.open_readwrite();
+                io.truncate(offset);
+                io.close();
+            }
+
+            log_size = offset;
+            reader = log_file.read();
+            writer = log_file.append_to(FileCreateFlags.PRIVATE);
+
+            stderr.printf("[PERF] CONVERSATIONSTORE: %d messages indexés (%lld octets)\n", offsets.length, log_size);
+        }
+
+        private void close_streams() {
+            try {
+                if (reader != null) {
+                    reader.close();
+                }
+                if (writer != null) {
+                    writer.close();
+                }
+            } catch (Error e) {
+                warning("Erreur lors de la fermeture du journal: %s", e.message);
+            }
+            reader = null;
+            writer = null;
+        }
+
+        /**
+         * Sérialise un message et l'ajoute à la fin du journal
+         */
+        private void write_message(ChatMessage message) throws Error {
+            if (writer == null) {
+                throw new IOError.CLOSED("Journal de conversation fermé");
+            }
+
+            var payload_stream = new MemoryOutputStream.resizable();
+            var payload = new DataOutputStream(payload_stream);
+            payload.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+
+            payload.put_byte((uint8) message.sender);
+            payload.put_int64(message.timestamp.to_unix());
+            payload.put_int64(message.completion_time != null ? message.completion_time.to_unix() : 0);
+            payload.put_byte(message.is_processing_complete ? 1 : 0);
+            payload.put_int32(message.token_count);
+            payload.put_int64((int64) (message.processing_duration * 1000000.0));
+
+            unowned string content = message.content ?? "";
+            payload.put_uint32((uint32) content.length);
+            payload.put_string(content);
+
+            int n_tokens = message.token_ids != null ? message.token_ids.length : 0;
+            payload.put_uint32((uint32) n_tokens);
+            for (int i = 0; i < n_tokens; i++) {
+                payload.put_int32(message.token_ids[i]);
+            }
+            payload.close();
+
+            uint8[] data = payload_stream.steal_data();
+            data.length = (int) payload_stream.get_data_size();
+
+            var record = new DataOutputStream(writer);
+            record.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+            record.set_close_base_stream(false);
+            record.put_byte(RECORD_MESSAGE);
+            record.put_uint32((uint32) data.length);
+            size_t written;
+            record.write_all(data, out written);
+            record.flush();
+
+            offsets += log_size;
+            log_size += 5 + data.length;
+        }
+
+        /**
+         * Relit un message depuis son offset dans le journal
+         */
+        private ChatMessage read_message_at(int64 offset) throws Error {
+            if (reader == null) {
+                throw new IOError.CLOSED("Journal de conversation fermé");
+            }
+
+            reader.seek(offset, SeekType.SET);
+            var dis = new DataInputStream(reader);
+            dis.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+            dis.set_close_base_stream(false);
+
+            dis.read_byte();   // Type d'enregistrement
+            dis.read_uint32(); // Taille de la charge utile
+
+            var sender = (ChatMessage.SenderType) dis.read_byte();
+            int64 timestamp = dis.read_int64();
+            int64 completion = dis.read_int64();
+            bool complete = dis.read_byte() != 0;
+            int32 token_count = dis.read_int32();
+            int64 duration_us = dis.read_int64();
+
+            // Octet nul supplémentaire pour pouvoir lire le tampon comme une chaîne C
+            uint32 content_size = dis.read_uint32();
+            uint8[] content_data = new uint8[content_size + 1];
+            content_data.length = (int) content_size;
+            size_t content_read;
+            dis.read_all(content_data, out content_read);
+
+            uint32 n_tokens = dis.read_uint32();
+            int[] token_ids = new int[n_tokens];
+            for (uint32 i = 0; i < n_tokens; i++) {
+                token_ids[i] = dis.read_int32();
+            }
+
+            var message = new ChatMessage((string) content_data, sender);
+            message.timestamp = new DateTime.from_unix_local(timestamp);
+            message.token_count = token_count;
+            message.processing_duration = duration_us / 1000000.0;
+            message.is_processing_complete = complete;
+            message.completion_time = completion != 0 ? new DateTime.from_unix_local(completion) : null;
+            message.token_ids = token_ids;
+            return message;
+        }
+
+        /**
+         * Ajoute un message au cache LRU et évince les plus anciens
+         */
+        private void remember(uint position, ChatMessage message) {
+            cache[position] = message;
+            cache_order.remove(position);
+            cache_order.offer_head(position);
+
+            while (cache_order.size > MAX_CACHED_MESSAGES) {
+                uint evicted = cache_order.poll_tail();
+                cache.unset(evicted);
+            }
+        }
+
+        ~ConversationStore() {
+            commit_live();
+            close_streams();
+        }
+    }
+}
@@ -0,0 +1,142 @@
+namespace Sambo {
+    /**
+     * File d'attente équitable pour l'accès au modèle chargé
+     *
+     * Le modèle et son contexte ne servent qu'une génération à la fois. Chaque
+     * demande prend un ticket ; quand le modèle se libère, le ticket le plus
+     * ancien d'un client différent du dernier servi passe en premier, ce qui
+     * alterne la session de chat et les clients du serveur local.
+     *
+     * acquire() est bloquant : à n'appeler que depuis un thread de génération.
+     */
+    public class GenerationScheduler : Object {
+        public const string INTERACTIVE_CLIENT = "interactive";
+        // Libération mémoire : ne compte pas comme une utilisation du modèle
+        public const string RESIDENCY_CLIENT = "residency";
+
+        private static GenerationScheduler? instance = null;
+
+        private class Ticket {
+            public uint id;
+            public string client;
+            public int64 queued_at;
+        }
+
+        private Mutex mutex = Mutex();
+        private Cond cond = Cond();
+        private Gee.LinkedList<Ticket> waiting = new Gee.LinkedList<Ticket>();
+        private Ticket? holder = null;
+        private string? last_client = null;
+        private uint next_ticket_id = 1;
+        private int64 last_activity = get_monotonic_time();
+
+        public static GenerationScheduler get_instance() {
+            if (instance == null) {
+                instance = new GenerationScheduler();
+            }
+            return instance;
+        }
+
+        /**
+         * Attend son tour puis réserve le modèle
+         * @return L'identifiant du ticket à passer à release()
+         */
+        public uint acquire(string client) {
+            mutex.lock();
+            var ticket = new Ticket();
+            ticket.id = next_ticket_id++;
+            ticket.client = client;
+            ticket.queued_at = get_monotonic_time();
+            waiting.add(ticket);
+
+            while (holder != null || next_ticket() != ticket) {
+                cond.wait(mutex);
+            }
+
+            waiting.remove(ticket);
+            holder = ticket;
+            last_client = client;
+            if (client != RESIDENCY_CLIENT) {
+                last_activity = get_monotonic_time();
+            }
+            int64 waited_us = get_monotonic_time() - ticket.queued_at;
+            int queue_length = waiting.size;
+            mutex.unlock();
+
+            if (waited_us > 1000) {
+                stderr.printf("[PERF] SCHEDULER: %s servi après %.1f ms d'attente (%d en file)\n",
+                    client, waited_us / 1000.0, queue_length);
+            }
+            return ticket.id;
+        }
+
+        /**
+         * Libère le modèle pour le ticket suivant
+         */
+        public void release(uint ticket_id) {
+            mutex.lock();
+            if (holder != null && holder.id == ticket_id) {
+                if (holder.client != RESIDENCY_CLIENT) {
+                    last_activity = get_monotonic_time();
+                }
+                holder = null;
+                cond.broadcast();
+            }
+            mutex.unlock();
+        }
+
+        /**
+         * Indique si le modèle est actuellement réservé par ce client
+         */
+        public bool is_held_by(string client) {
+            mutex.lock();
+            bool held = holder != null && holder.client == client;
+            mutex.unlock();
+            return held;
+        }
+
+        /**
+         * Indique si ce ticket détient actuellement le modèle
+         */
+        public bool is_holding(uint ticket_id) {
+            mutex.lock();
+            bool held = holder != null && holder.id == ticket_id;
+            mutex.unlock();
+            return held;
+        }
+
+        /**
+         * Nombre de demandes en attente
+         */
+        public int get_queue_length() {
+            mutex.lock();
+            int length = waiting.size;
+            mutex.unlock();
+            return length;
+        }
+
+        /**
+         * Temps écoulé depuis la dernière utilisation du modèle, en microsecondes
+         * @return 0 si une génération est en cours ou en attente
+         */
+        public int64 get_idle_time() {
+            mutex.lock();
+            bool busy = !waiting.is_empty || (holder != null && holder.client != RESIDENCY_CLIENT);
+            int64 idle = busy ? 0 : get_monotonic_time() - last_activity;
+            mutex.unlock();
+            return idle;
+        }
+
+        /**
+         * Ticket à servir ensuite (appelée sous verrou)
+         */
+        private Ticket? next_ticket() {
+            foreach (var ticket in waiting) {
+                if (ticket.client != last_client) {
+                    return ticket;
+                }
+            }
+            return waiting.is_empty ? null : waiting.first();
+        }
+    }
+}
@@ -2,6 +2,19 @@ using GLib;
 using Gee;
 
 namespace Sambo {
+    /**
+     * Adaptateur LoRA appliqué par un profil au-dessus du modèle de base
+     */
+    public class LoraAdapter : Object {
+        public string path { get; set; }
+        public float scale { get; set; default = 1.0f; }
+
+        public LoraAdapter(string path, float scale = 1.0f) {
+            this.path = path;
+            this.scale = scale;
+        }
+    }
+
     /**
      * Représente un profil d'inférence complet
      */
@@ -25,6 +38,13 @@ namespace Sambo {
         public int context_length { get; set; default = 2048; }
         public bool stream { get; set; default = true; }
 
+        // Cache KV : précision ("f16", "q8_0", "q4_0") et flash attention
+        public string kv_cache_type { get; set; default = "f16"; }
+        public bool flash_attention { get; set; default = false; }
+
+        // Adaptateurs LoRA attachés au modèle de base (sans rechargement)
+        public ArrayList<LoraAdapter> lora_adapters { get; set; default = new ArrayList<LoraAdapter>(); }
+
         public InferenceProfile(string id = "", string title = "", string comment = "", string prompt = "", string model_path = "") {
             this.id = id;
             this.title = title;
@@ -95,6 +115,34 @@ namespace Sambo {
             this.seed = other.seed;
             this.context_length = other.context_length;
             this.stream = other.stream;
+            this.kv_cache_type = other.kv_cache_type;
+            this.flash_attention = other.flash_attention;
+
+            this.lora_adapters = new ArrayList<LoraAdapter>();
+            foreach (var adapter in other.lora_adapters) {
+                this.lora_adapters.add(new LoraAdapter(adapter.path, adapter.scale));
+            }
+        }
+
+        /**
+         * Précision du cache KV pour le wrapper
+         */
+        public Llama.KvCacheType get_kv_cache_type() {
+            return parse_kv_cache_type(kv_cache_type);
+        }
+
+        /**
+         * Convertit un nom de précision ("f16", "q8_0", "q4_0"), f16 si inconnu
+         */
+        public static Llama.KvCacheType parse_kv_cache_type(string name) {
+            switch (name) {
+                case "q8_0":
+                    return Llama.KvCacheType.Q8_0;
+                case "q4_0":
+                    return Llama.KvCacheType.Q4_0;
+                default:
+                    return Llama.KvCacheType.F16;
+            }
         }
 
         /**
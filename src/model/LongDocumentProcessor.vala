@@ -0,0 +1,465 @@
+using Sambo.Document;
+
+namespace Sambo {
+    /**
+     * Portion d'un document long, découpée selon sa structure
+     */
+    public class DocumentChunk : Object {
+        public int index;
+        public string section;   // Titres englobants, "Titre > Sous-titre"
+        public string text;      // Contenu en Markdown
+        public int tokens;
+    }
+
+    /**
+     * Traitement map-reduce d'un document long envoyé de l'éditeur au chat
+     *
+     * Le document pivot est découpé selon ses titres et paragraphes en
+     * portions qui tiennent dans le contexte du profil. La consigne est
+     * appliquée à chaque portion (étape map), plusieurs portions étant
+     * décodées en séquences parallèles dans un même batch. Les réponses
+     * partielles sont ensuite combinées en une réponse finale diffusée token
+     * par token (étape reduce). Si elles dépassent elles-mêmes le contexte,
+     * elles sont d'abord regroupées par passes intermédiaires.
+     *
+     * Les signaux sont émis sur le thread principal.
+     */
+    public class LongDocumentProcessor : Object {
+        public const string CLIENT_ID = "long-document";
+        private const int MAX_PARALLEL = 4;
+        private const int MAP_MAX_TOKENS = 256;
+        private const int MIN_CHUNK_TOKENS = 128;
+        private const int MAX_CHUNK_TOKENS = 1536;
+        // Balises du template et consignes autour du contenu
+        private const int PROMPT_OVERHEAD_TOKENS = 96;
+
+        private ModelManager model_manager;
+        private InferenceProfile profile;
+        private Cancellable cancellable = new Cancellable();
+
+        public signal void chunking_done(int chunk_count, int parallel);
+        public signal void map_progress(int completed, int total);
+        public signal void reduce_started(int partial_count);
+        public signal void token_received(string token);
+        public signal void finished(bool success, string? error_message);
+
+        public LongDocumentProcessor(ModelManager model_manager, InferenceProfile profile) {
+            this.model_manager = model_manager;
+            this.profile = profile;
+        }
+
+        /**
+         * Lance le traitement dans un thread de travail
+         *
+         * À appeler depuis le thread principal : l'éditeur continue de
+         * modifier le document, le thread de travail n'en reçoit qu'une copie.
+         */
+        public void start(PivotDocument document, string instruction) {
+            var nodes = DocumentChunker.snapshot(document);
+            new Thread<void*>("long_document", () => {
+                string? error = null;
+                bool success = run(nodes, instruction, out error);
+                Idle.add(() => {
+                    finished(success, error);
+                    return Source.REMOVE;
+                });
+                return null;
+            });
+        }
+
+        public void cancel() {
+            cancellable.cancel();
+        }
+
+        private bool run(Gee.List<DocumentNodeSnapshot> nodes, string instruction, out string? error) {
+            error = null;
+            var start_time = get_monotonic_time();
+
+            // Budgets tirés du contexte seul : chaque prompt et sa réponse doivent y tenir
+            int n_ctx = profile.context_length;
+            int overhead = PROMPT_OVERHEAD_TOKENS + model_manager.count_tokens(profile.prompt + instruction);
+            int map_tokens = int.min(MAP_MAX_TOKENS, n_ctx / 4);
+            // Deux séquences au moins si le contexte le permet, sinon une seule
+            int chunk_budget = int.min(n_ctx / 2 - map_tokens - overhead, MAX_CHUNK_TOKENS);
+            if (chunk_budget < MIN_CHUNK_TOKENS) {
+                chunk_budget = int.min(n_ctx - map_tokens - overhead, MAX_CHUNK_TOKENS);
+            }
+            // La réponse finale laisse au moins la place d'une réponse partielle
+            int min_reduce_budget = int.max(map_tokens, MIN_CHUNK_TOKENS);
+            int reduce_tokens = int.min(profile.max_tokens, n_ctx - overhead - min_reduce_budget);
+            int reduce_budget = n_ctx - reduce_tokens - overhead;
+            if (chunk_budget < MIN_CHUNK_TOKENS || reduce_tokens <= 0) {
+                error = "Contexte de %d tokens trop petit pour traiter un document long".printf(n_ctx);
+                return false;
+            }
+            int parallel = (n_ctx / (chunk_budget + map_tokens + overhead)).clamp(1, MAX_PARALLEL);
+
+            var chunker = new DocumentChunker(model_manager, chunk_budget);
+            var chunks = chunker.split(nodes);
+            if (chunks.size == 0) {
+                error = "Le document est vide";
+                return false;
+            }
+
+            int total = chunks.size;
+            Idle.add(() => {
+                chunking_done(total, parallel);
+                return Source.REMOVE;
+            });
+            stderr.printf("[PERF] LONGDOC: %d portions de %d tokens max, %d séquences parallèles (contexte %d)\n",
+                total, chunk_budget, parallel, n_ctx);
+
+            var params = make_params(map_tokens);
+
+            // Étape map : portions traitées par groupes de séquences parallèles
+            var partials = new Gee.ArrayList<string>();
+            for (int first = 0; first < total; first += parallel) {
+                if (cancellable.is_cancelled()) {
+                    error = "Traitement annulé";
+                    return false;
+                }
+
+                int count = int.min(parallel, total - first);
+                var prompts = new string[count];
+                for (int i = 0; i < count; i++) {
+                    var chunk = chunks[first + i];
+                    string header = chunk.section != "" ? "Section : %s\n\n".printf(chunk.section) : "";
+                    prompts[i] = build_prompt(
+                        "Voici la partie %d sur %d d'un document long.\n\n%s%s\n\nConsigne : %s\nRéponds uniquement à partir de cette partie, de façon concise.".printf(
+                            chunk.index + 1, total, header, chunk.text, instruction));
+                }
+
+                var answers = run_parallel(prompts, params);
+                if (answers == null) {
+                    error = cancellable.is_cancelled() ? "Traitement annulé" : "Échec de la génération pour une portion";
+                    return false;
+                }
+                for (int i = 0; i < count; i++) {
+                    var chunk = chunks[first + i];
+                    string label = chunk.section != "" ? chunk.section : "Partie %d".printf(chunk.index + 1);
+                    partials.add("### %s\n%s".printf(label, answers[i].strip()));
+                }
+
+                int completed = first + count;
+                Idle.add(() => {
+                    map_progress(completed, total);
+                    return Source.REMOVE;
+                });
+            }
+
+            // Passes intermédiaires tant que les réponses partielles dépassent le contexte
+            while (partials.size > 1 && count_all(partials) > reduce_budget) {
+                var groups = group_partials(partials, chunk_budget);
+                if (groups.size >= partials.size) {
+                    break;
+                }
+                var prompts = new string[groups.size];
+                for (int i = 0; i < groups.size; i++) {
+                    prompts[i] = build_prompt(
+                        "Voici des réponses partielles obtenues sur des parties successives d'un document.\n\n%s\n\nConsigne : %s\nCombine-les en une réponse concise qui conserve les informations utiles.".printf(
+                            groups[i], instruction));
+                }
+
+                var combined = new Gee.ArrayList<string>();
+                for (int first = 0; first < prompts.length; first += parallel) {
+                    int count = int.min(parallel, prompts.length - first);
+                    var answers = run_parallel(prompts[first:first + count], params);
+                    if (answers == null) {
+                        error = cancellable.is_cancelled() ? "Traitement annulé" : "Échec de la combinaison des réponses";
+                        return false;
+                    }
+                    foreach (var answer in answers) {
+                        combined.add(answer.strip());
+                    }
+                }
+                stderr.printf("[PERF] LONGDOC: Passe intermédiaire %d → %d réponses\n", partials.size, combined.size);
+                partials = combined;
+            }
+            if (count_all(partials) > reduce_budget) {
+                error = "Réponses partielles trop longues pour le contexte de %d tokens".printf(n_ctx);
+                return false;
+            }
+
+            // Étape reduce : réponse finale diffusée en continu
+            int partial_count = partials.size;
+            Idle.add(() => {
+                reduce_started(partial_count);
+                return Source.REMOVE;
+            });
+
+            string reduce_prompt = build_prompt(
+                "Voici les réponses obtenues sur chacune des parties d'un document.\n\n%s\n\nConsigne : %s\nRéponds pour l'ensemble du document en t'appuyant sur ces réponses.".printf(
+                    string.joinv("\n\n", partials.to_array()), instruction));
+
+            bool success = model_manager.generate_for_client(CLIENT_ID, reduce_prompt, make_params(reduce_tokens), (token) => {
+                Idle.add(() => {
+                    token_received(token);
+                    return Source.REMOVE;
+                });
+                return true;
+            }, cancellable, profile.lora_adapters);
+
+            if (!success) {
+                error = cancellable.is_cancelled() ? "Traitement annulé" : "Échec de la synthèse finale";
+                return false;
+            }
+
+            stderr.printf("[PERF] LONGDOC: %d portions traitées en %.1f s\n",
+                total, (get_monotonic_time() - start_time) / 1000000.0);
+            return true;
+        }
+
+        /**
+         * Génère les prompts en parallèle et renvoie le texte complet de chacun
+         */
+        private string[]? run_parallel(string[] prompts, Llama.SamplingParams params) {
+            var outputs = new StringBuilder[prompts.length];
+            for (int i = 0; i < prompts.length; i++) {
+                outputs[i] = new StringBuilder();
+            }
+
+            bool success = model_manager.generate_parallel_for_client(CLIENT_ID, prompts, params, (sequence, token) => {
+                outputs[sequence].append(token);
+                return true;
+            }, cancellable, profile.lora_adapters);
+
+            if (!success || cancellable.is_cancelled()) {
+                return null;
+            }
+
+            var answers = new string[prompts.length];
+            for (int i = 0; i < prompts.length; i++) {
+                answers[i] = outputs[i].str;
+            }
+            return answers;
+        }
+
+        /**
+         * Regroupe des réponses partielles consécutives dans la limite du budget
+         */
+        private Gee.List<string> group_partials(Gee.List<string> partials, int budget) {
+            var groups = new Gee.ArrayList<string>();
+            var current = new StringBuilder();
+            int current_tokens = 0;
+
+            foreach (var partial in partials) {
+                int tokens = model_manager.count_tokens(partial);
+                if (current.len > 0 && current_tokens + tokens > budget) {
+                    groups.add(current.str);
+                    current.truncate(0);
+                    current_tokens = 0;
+                }
+                if (current.len > 0) {
+                    current.append("\n\n");
+                }
+                current.append(partial);
+                current_tokens += tokens;
+            }
+            if (current.len > 0) {
+                groups.add(current.str);
+            }
+            return groups;
+        }
+
+        private int count_all(Gee.List<string> texts) {
+            int total = 0;
+            foreach (var text in texts) {
+                total += model_manager.count_tokens(text);
+            }
+            return total;
+        }
+
+        private Llama.SamplingParams make_params(int max_tokens) {
+            Llama.SamplingParams params = {
+                profile.temperature,
+                profile.top_p,
+                profile.top_k,
+                max_tokens,
+                profile.repetition_penalty,
+                profile.frequency_penalty,
+                profile.presence_penalty,
+                profile.seed,
+                profile.context_length,
+                true,
+                profile.get_kv_cache_type(),
+                profile.flash_attention
+            };
+            return params;
+        }
+
+        private string build_prompt(string user_message) {
+            if (profile.template != null && profile.template.strip() != "") {
+                return profile.template.replace("{system}", profile.prompt)
+                                       .replace("{user}", user_message)
+                                       .replace("{assistant}", "");
+            }
+            return "<|begin_of_text|><|start_header_id|>system<|end_header_id|>\n\n" + profile.prompt +
+                   "<|eot_id|><|start_header_id|>user<|end_header_id|>\n\n" + user_message +
+                   "<|eot_id|><|start_header_id|>assistant<|end_header_id|>\n\n";
+        }
+    }
+
+    /**
+     * Copie d'un nœud du document pivot, en Markdown
+     */
+    private class DocumentNodeSnapshot {
+        public int heading_level;   // 0 si le nœud n'est pas un titre
+        public string heading_text;
+        public string markdown;
+    }
+
+    /**
+     * Découpe un document pivot en portions d'au plus budget tokens
+     *
+     * Un titre de niveau 1 ou 2 commence toujours une nouvelle portion ; les
+     * autres nœuds sont regroupés tant que le budget le permet. Un nœud trop
+     * long à lui seul est coupé aux fins de ligne ou de phrase.
+     */
+    private class DocumentChunker {
+        private ModelManager model_manager;
+        private int budget;
+
+        private Gee.ArrayList<DocumentChunk> chunks = new Gee.ArrayList<DocumentChunk>();
+        private Gee.ArrayList<string> heading_path = new Gee.ArrayList<string>();
+        private StringBuilder current = new StringBuilder();
+        private int current_tokens = 0;
+        private string current_section = "";
+
+        public DocumentChunker(ModelManager model_manager, int budget) {
+            this.model_manager = model_manager;
+            this.budget = budget;
+        }
+
+        /**
+         * Copie les nœuds du document (thread principal)
+         */
+        public static Gee.List<DocumentNodeSnapshot> snapshot(PivotDocument document) {
+            var nodes = new Gee.ArrayList<DocumentNodeSnapshot>();
+            foreach (var node in document.children) {
+                var copy = new DocumentNodeSnapshot();
+                copy.heading_level = 0;
+                copy.heading_text = "";
+                if (node is PivotHeading) {
+                    var heading = (PivotHeading) node;
+                    copy.heading_level = int.max(heading.level, 1);
+                    copy.heading_text = heading.text.strip();
+                }
+                copy.markdown = node.to_markdown().strip();
+                nodes.add(copy);
+            }
+            return nodes;
+        }
+
+        public Gee.List<DocumentChunk> split(Gee.List<DocumentNodeSnapshot> nodes) {
+            foreach (var node in nodes) {
+                if (node.heading_level > 0) {
+                    if (node.heading_level <= 2) {
+                        flush();
+                    }
+                    while (heading_path.size >= node.heading_level && heading_path.size > 0) {
+                        heading_path.remove_at(heading_path.size - 1);
+                    }
+                    heading_path.add(node.heading_text);
+                }
+
+                string text = node.markdown;
+                if (text == "") {
+                    continue;
+                }
+                int tokens = model_manager.count_tokens(text);
+
+                if (tokens > budget) {
+                    flush();
+                    foreach (var piece in split_oversized(text, tokens)) {
+                        append(piece, model_manager.count_tokens(piece));
+                        flush();
+                    }
+                    continue;
+                }
+
+                if (current_tokens + tokens > budget) {
+                    flush();
+                }
+                append(text, tokens);
+            }
+            flush();
+            return chunks;
+        }
+
+        private void append(string text, int tokens) {
+            if (current.len == 0) {
+                current_section = string.joinv(" > ", heading_path.to_array());
+            } else {
+                current.append("\n\n");
+            }
+            current.append(text);
+            current_tokens += tokens;
+        }
+
+        private void flush() {
+            if (current.len == 0) {
+                return;
+            }
+            var chunk = new DocumentChunk();
+            chunk.index = chunks.size;
+            chunk.section = current_section;
+            chunk.text = current.str;
+            chunk.tokens = current_tokens;
+            chunks.add(chunk);
+
+            current.truncate(0);
+            current_tokens = 0;
+        }
+
+        /**
+         * Coupe un texte trop long en morceaux proportionnels au budget
+         */
+        private Gee.List<string> split_oversized(string text, int tokens) {
+            var pieces = new Gee.ArrayList<string>();
+            // Marge de 10 % : le rapport octets/token varie dans le texte
+            long max_bytes = (long) ((double) text.length * budget / tokens * 0.9);
+            if (max_bytes < 64) {
+                max_bytes = 64;
+            }
+
+            long start = 0;
+            while (start < text.length) {
+                long end = start + max_bytes;
+                if (end >= text.length) {
+                    pieces.add(text.substring(start).strip());
+                    break;
+                }
+
+                // Couper de préférence à une fin de ligne, de phrase ou de mot
+                long cut = last_boundary(text, start, end, "\n");
+                if (cut < 0) cut = last_boundary(text, start, end, ". ");
+                if (cut < 0) cut = last_boundary(text, start, end, " ");
+                if (cut < 0) {
+                    cut = end;
+                    while (cut > start && ((uchar) text[cut] & 0xC0) == 0x80) {
+                        cut--;
+                    }
+                }
+
+                pieces.add(text.substring(start, cut - start).strip());
+                start = cut;
+            }
+            return pieces;
+        }
+
+        private long last_boundary(string text, long start, long end, string separator) {
+            long position = -1;
+            long search = start;
+            while (true) {
+                int found = text.index_of(separator, (int) search);
+                if (found < 0 || found + separator.length > end) {
+                    break;
+                }
+                position = found + separator.length;
+                search = position;
+            }
+            // Éviter les morceaux minuscules
+            return position > start + (end - start) / 2 ? position : -1;
+        }
+    }
+}
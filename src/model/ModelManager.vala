@@ -18,14 +18,18 @@ namespace Sambo {
         // Optimisations mémoire
         private bool model_preloaded = false;            // Modèle gardé en mémoire
         private string preloaded_model_path = "";        // Chemin du modèle préchargé
-        private StringBuilder context_pool;              // Pool de contextes réutilisables
-        private int64 last_gc_time = 0;                  // Timestamp dernier garbage collection
+        private bool memory_release_pending = false;     // Libération mémoire en cours
+
+        // Adaptateurs LoRA du profil courant, attachés à chaque génération interactive
+        private Gee.List<LoraAdapter> session_adapters = new Gee.ArrayList<LoraAdapter>();
 
         // Signaux pour informer l'interface
         public signal void model_loaded(string model_path, string model_name);
         public signal void model_load_failed(string model_path, string error_message);
         public signal void model_unloaded();
+        public signal void model_changing(string model_path); // Émis avant de remplacer le modèle courant
         public signal void generation_cancelled(); // Signal d'annulation
+        public signal void memory_released(bool model_suspended); // Cache KV libéré ou modèle suspendu
 
         /**
          * Singleton - obtenir l'instance unique
@@ -45,11 +49,6 @@ namespace Sambo {
             config_manager = new ConfigManager();
             config_manager.load();
 
-            // Initialiser les optimisations mémoire
-            context_pool = new StringBuilder();
-            context_pool.truncate(0);
-            last_gc_time = get_monotonic_time();
-
             // Initialiser le backend llama.cpp
             init_backend();
         }
@@ -163,6 +162,11 @@ namespace Sambo {
                 return false;
             }
 
+            // Prévenir les clients qui génèrent avec le modèle courant avant de le remplacer
+            if (current_model_path != model_path) {
+                model_changing(model_path);
+            }
+
             // Optimisation : si le modèle est déjà préchargé, pas besoin de le recharger
             if (model_preloaded && preloaded_model_path == model_path && is_model_loaded) {
                 // Vérifier que le modèle est vraiment chargé côté llama.cpp
@@ -208,8 +212,8 @@ namespace Sambo {
                     model_preloaded = true;
                     preloaded_model_path = model_path;
 
-                    // Forcer un garbage collection après chargement
-                    force_garbage_collection();
+                    // Rendre résidents les adaptateurs du profil courant
+                    preload_adapters_async(session_adapters);
 
                     string model_name = Path.get_basename(model_path);
                     model_loaded(model_path, model_name);
@@ -234,6 +238,84 @@ namespace Sambo {
             }
         }
 
+        /**
+         * Définit la taille du contexte et la précision du cache KV du prochain chargement
+         *
+         * Chaque génération réapplique ensuite les réglages de son profil : le
+         * contexte n'est recréé que s'ils diffèrent, sans recharger le modèle.
+         */
+        public void set_context_options(InferenceProfile profile) {
+            Llama.set_load_context_params(profile.context_length, profile.get_kv_cache_type(), profile.flash_attention);
+
+            int64 kv_bytes = Llama.estimate_kv_cache_size(profile.model_path, profile.context_length,
+                                                          profile.get_kv_cache_type(), profile.flash_attention);
+            if (kv_bytes >= 0) {
+                stderr.printf("[PERF] MODELMANAGER: Cache KV estimé à %s (%d tokens, %s, flash attention %s)\n",
+                    format_size((uint64) kv_bytes), profile.context_length, profile.kv_cache_type,
+                    profile.flash_attention ? "activée" : "désactivée");
+            }
+        }
+
+        /**
+         * Définit les adaptateurs LoRA de la session interactive
+         *
+         * Ils sont attachés au début de la prochaine génération : changer de
+         * profil sur le même modèle de base ne demande aucun rechargement.
+         */
+        public void set_session_adapters(Gee.List<LoraAdapter> adapters) {
+            var copy = new Gee.ArrayList<LoraAdapter>();
+            copy.add_all(adapters);
+            session_adapters = copy;
+
+            if (is_model_ready() && !is_simulation_mode) {
+                preload_adapters_async(copy);
+            }
+        }
+
+        /**
+         * Charge en arrière-plan les adaptateurs pas encore résidents
+         */
+        private void preload_adapters_async(Gee.List<LoraAdapter> adapters) {
+            if (adapters.size == 0) {
+                return;
+            }
+
+            new Thread<void*>("lora_preloader", () => {
+                foreach (var adapter in adapters) {
+                    if (!Llama.preload_lora_adapter(adapter.path)) {
+                        warning("Impossible de charger l'adaptateur LoRA %s", adapter.path);
+                    }
+                }
+                return null;
+            });
+        }
+
+        /**
+         * Attache les adaptateurs demandés au contexte (thread de génération, tour acquis)
+         *
+         * Sans effet si la même combinaison est déjà attachée.
+         */
+        private static void apply_adapters(Gee.List<LoraAdapter>? adapters) {
+            if (!Llama.is_model_loaded()) {
+                return;
+            }
+
+            int count = adapters != null ? adapters.size : 0;
+            var paths = new string[count];
+            var scales = new float[count];
+            for (int i = 0; i < count; i++) {
+                paths[i] = adapters[i].path;
+                scales[i] = adapters[i].scale;
+            }
+
+            var start_time = get_monotonic_time();
+            if (!Llama.set_lora_adapters(paths, scales, count)) {
+                warning("Certains adaptateurs LoRA n'ont pas pu être attachés");
+            }
+            stderr.printf("[PERF] MODELMANAGER: %d adaptateur(s) LoRA prêts en %.1f ms\n",
+                count, (get_monotonic_time() - start_time) / 1000.0);
+        }
+
         /**
          * Précharge un modèle en arrière-plan pour accélérer les futurs chargements
          */
@@ -260,28 +342,69 @@ namespace Sambo {
         }
 
         /**
-         * Force un garbage collection intelligent
+         * Libère de la mémoire sans perdre la session, dans un thread de travail
+         *
+         * Sans suspension, seul le cache KV est libéré ; avec, le modèle l'est
+         * aussi. L'état de session est sauvegardé sur disque, et le wrapper
+         * recharge le tout à la prochaine génération. Rien n'est fait si le
+         * modèle a servi depuis moins de min_idle_seconds.
          */
-        private void force_garbage_collection() {
-            var current_time = get_monotonic_time();
-
-            // Éviter les GC trop fréquents (max 1 par minute)
-            if (current_time - last_gc_time < 60000000) { // 60 secondes
+        public void release_memory(bool suspend_model, int min_idle_seconds) {
+            if (!is_model_ready() || is_simulation_mode || memory_release_pending) {
                 return;
             }
+            memory_release_pending = true;
+            string state_path = get_session_state_path();
+
+            new Thread<void*>("model_residency", () => {
+                var scheduler = GenerationScheduler.get_instance();
+                uint ticket = scheduler.acquire(GenerationScheduler.RESIDENCY_CLIENT);
 
-            stderr.printf("[PERF] MODELMANAGER: Garbage collection forcé\n");
+                bool released = false;
+                var start_time = get_monotonic_time();
+                if (scheduler.get_idle_time() >= (int64) min_idle_seconds * 1000000) {
+                    released = suspend_model ? Llama.suspend_model(state_path) : Llama.release_kv_cache(state_path);
+                }
+                scheduler.release(ticket);
+
+                if (released) {
+                    stderr.printf("[PERF] MODELMANAGER: %s en %.1f ms\n",
+                        suspend_model ? "Modèle suspendu" : "Cache KV libéré",
+                        (get_monotonic_time() - start_time) / 1000.0);
+                }
 
-            // Nettoyer les StringBuilder réutilisables
-            context_pool.truncate(0);
+                Idle.add(() => {
+                    memory_release_pending = false;
+                    if (released) {
+                        memory_released(suspend_model);
+                    }
+                    return Source.REMOVE;
+                });
+                return null;
+            });
+        }
 
-            // En Vala, le garbage collection se fait automatiquement
-            // On peut juste nettoyer les références locales et forcer un petit délai
-            Thread.usleep(10000); // 10ms pour permettre le nettoyage automatique
+        /**
+         * Indique si les poids du modèle sont en mémoire (false s'il est suspendu)
+         */
+        public bool is_model_resident() {
+            return is_model_ready() && Llama.is_model_resident();
+        }
 
-            last_gc_time = current_time;
+        /**
+         * Indique si le contexte et son cache KV sont alloués
+         */
+        public bool has_kv_cache() {
+            return is_model_ready() && Llama.has_kv_cache();
+        }
 
-            stderr.printf("[PERF] MODELMANAGER: Garbage collection terminé\n");
+        /**
+         * Fichier où l'état de session est sauvegardé pendant une libération
+         */
+        private string get_session_state_path() {
+            string cache_dir = Path.build_filename(Environment.get_user_cache_dir(), "sambo");
+            DirUtils.create_with_parents(cache_dir, 0755);
+            return Path.build_filename(cache_dir, "session.kvstate");
         }
 
         /**
@@ -413,6 +536,7 @@ namespace Sambo {
 
             // Copier le callback pour éviter les problèmes de mémoire
             GenerationCallback? local_callback = callback;
+            var local_adapters = session_adapters;
 
             current_generation_thread = new Thread<void*>("ai_generation", () => {
                 // Vérifier l'annulation avant de commencer
@@ -426,6 +550,23 @@ namespace Sambo {
                     return null;
                 }
 
+                // Attendre notre tour si le serveur local utilise le modèle
+                var scheduler = GenerationScheduler.get_instance();
+                uint ticket = scheduler.acquire(GenerationScheduler.INTERACTIVE_CLIENT);
+                if (is_generation_cancelled) {
+                    scheduler.release(ticket);
+                    Idle.add(() => {
+                        if (local_callback != null) {
+                            local_callback("⏹️ Génération annulée", true);
+                        }
+                        return Source.REMOVE;
+                    });
+                    return null;
+                }
+                if (!is_simulation_mode) {
+                    apply_adapters(local_adapters);
+                }
+
                 string? response = null;
                 bool generation_successful = false;
 
@@ -468,6 +609,7 @@ namespace Sambo {
 
                     // Vérifier l'annulation après la génération
                     if (is_generation_cancelled) {
+                        scheduler.release(ticket);
                         Idle.add(() => {
                             if (local_callback != null) {
                                 local_callback("⏹️ Génération annulée", true);
@@ -482,6 +624,8 @@ namespace Sambo {
                     generation_successful = false;
                 }
 
+                scheduler.release(ticket);
+
                 // Vérifier le timeout (seulement si configuré)
                 if (timeout_microseconds > 0) {
                     var elapsed_time = get_monotonic_time() - start_time;
@@ -568,6 +712,129 @@ namespace Sambo {
             }
         }
 
+        /**
+         * Génération bloquante pour un client non interactif (serveur local, traitements par lot)
+         *
+         * À appeler depuis un thread de travail : l'appel attend son tour auprès
+         * du GenerationScheduler puis transmet chaque token à on_token, dans ce
+         * même thread. La génération s'arrête si on_token retourne false ou si
+         * cancellable est annulé. Les adaptateurs LoRA donnés (aucun si null)
+         * sont attachés pour cette génération uniquement.
+         * @return false si le modèle n'est pas disponible ou si la génération a échoué
+         */
+        public bool generate_for_client(string client, string prompt, Llama.SamplingParams params, TokenCallback on_token,
+                                        Cancellable? cancellable = null, Gee.List<LoraAdapter>? adapters = null) {
+            if (!is_model_ready() || is_simulation_mode) {
+                return false;
+            }
+
+            var scheduler = GenerationScheduler.get_instance();
+            uint ticket = scheduler.acquire(client);
+
+            if ((cancellable != null && cancellable.is_cancelled()) || !Llama.is_model_loaded()) {
+                scheduler.release(ticket);
+                return false;
+            }
+
+            apply_adapters(adapters);
+
+            ClientStreamContext context = {};
+            context.on_token = on_token;
+            context.cancellable = cancellable;
+            context.stopped = false;
+
+            var start_time = get_monotonic_time();
+            Llama.SamplingParams local_params = params;
+            bool success = Llama.generate(prompt, &local_params, client_stream_callback, &context);
+            scheduler.release(ticket);
+
+            stderr.printf("[PERF] MODELMANAGER: Génération %s terminée en %.1f ms\n",
+                client, (get_monotonic_time() - start_time) / 1000.0);
+            return success;
+        }
+
+        /**
+         * Génère plusieurs prompts en séquences parallèles pour un client du modèle
+         *
+         * Mêmes règles que generate_for_client : appel bloquant depuis un thread
+         * de travail, après avoir obtenu son tour. Les prompts sont décodés
+         * ensemble, un token par séquence à chaque passe, et on_token reçoit
+         * l'indice du prompt concerné.
+         * @return false si le modèle n'est pas disponible ou si la génération a échoué
+         */
+        public bool generate_parallel_for_client(string client, string[] prompts, Llama.SamplingParams params,
+                                                 SequenceTokenCallback on_token, Cancellable? cancellable = null,
+                                                 Gee.List<LoraAdapter>? adapters = null) {
+            if (!is_model_ready() || is_simulation_mode || prompts.length == 0) {
+                return false;
+            }
+
+            var scheduler = GenerationScheduler.get_instance();
+            uint ticket = scheduler.acquire(client);
+
+            if ((cancellable != null && cancellable.is_cancelled()) || !Llama.is_model_loaded()) {
+                scheduler.release(ticket);
+                return false;
+            }
+
+            apply_adapters(adapters);
+
+            ParallelStreamContext context = {};
+            context.on_token = on_token;
+            context.cancellable = cancellable;
+
+            var start_time = get_monotonic_time();
+            Llama.SamplingParams local_params = params;
+            bool success = Llama.generate_parallel(prompts, prompts.length, &local_params, parallel_stream_callback, &context);
+            scheduler.release(ticket);
+
+            stderr.printf("[PERF] MODELMANAGER: Génération parallèle %s (%d séquences) terminée en %.1f ms\n",
+                client, prompts.length, (get_monotonic_time() - start_time) / 1000.0);
+            return success;
+        }
+
+        /**
+         * Nombre de tokens d'un texte pour le modèle courant, estimé si indisponible
+         */
+        public int count_tokens(string text) {
+            int count = is_model_ready() && !is_simulation_mode ? Llama.count_tokens(text) : -1;
+            // Environ 4 caractères par token en moyenne
+            return count >= 0 ? count : (int) (text.length / 4) + 1;
+        }
+
+        // Contexte transmis au callback C pour generate_parallel_for_client
+        private struct ParallelStreamContext {
+            unowned SequenceTokenCallback on_token;
+            unowned Cancellable? cancellable;
+        }
+
+        private static bool parallel_stream_callback(int sequence, string token, void* user_data) {
+            ParallelStreamContext* context = (ParallelStreamContext*)user_data;
+            if (context->cancellable != null && context->cancellable.is_cancelled()) {
+                return false;
+            }
+            return context->on_token(sequence, token);
+        }
+
+        // Contexte transmis au callback C pour generate_for_client
+        private struct ClientStreamContext {
+            unowned TokenCallback on_token;
+            unowned Cancellable? cancellable;
+            bool stopped;
+        }
+
+        private static void client_stream_callback(string token, void* user_data, void* closure_data) {
+            ClientStreamContext* context = (ClientStreamContext*)user_data;
+            if (context == null || context->stopped || token == null || token == "") {
+                return;
+            }
+
+            if ((context->cancellable != null && context->cancellable.is_cancelled()) || !context->on_token(token)) {
+                context->stopped = true;
+                Llama.stop_generation();
+            }
+        }
+
         /**
          * Génère une réponse simulée pour les tests
          */
@@ -1018,8 +1285,8 @@ Cette réponse est générée en mode simulation car llama.cpp n'est pas disponi
             try {
                 is_generation_cancelled = true;
 
-                // Arrêter la génération llama.cpp si elle est en cours
-                if (!is_simulation_mode) {
+                // Arrêter la génération llama.cpp si elle est en cours (et pas celle d'un client du serveur local)
+                if (!is_simulation_mode && GenerationScheduler.get_instance().is_held_by(GenerationScheduler.INTERACTIVE_CLIENT)) {
                     stderr.printf("🔍 ModelManager: Appel Llama.stop_generation\n");
                     try {
                         Llama.stop_generation();
@@ -1076,6 +1343,18 @@ Cette réponse est générée en mode simulation car llama.cpp n'est pas disponi
          */
         public delegate void GenerationCallback(string partial_response, bool is_finished);
 
+        /**
+         * Type de délégué pour generate_for_client, appelé dans le thread de génération
+         * @param token Texte du token généré
+         * @return false pour interrompre la génération
+         */
+        public delegate bool TokenCallback(string token);
+
+        /**
+         * Type de délégué pour generate_parallel_for_client, avec l'indice du prompt
+         */
+        public delegate bool SequenceTokenCallback(int sequence, string token);
+
         /**
          * Met à jour la configuration du timeout depuis les préférences
          */
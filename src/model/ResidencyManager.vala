@@ -0,0 +1,125 @@
+namespace Sambo {
+    /**
+     * Résidence du modèle en mémoire selon la pression mémoire et l'inactivité
+     *
+     * Surveille la mémoire disponible (/proc/meminfo) et les alertes de
+     * GMemoryMonitor. Sous pression, le cache KV est libéré en premier, puis
+     * le modèle est suspendu s'il reste inactif. Les mêmes étapes s'appliquent
+     * après une longue inactivité. L'état de session est sauvegardé et le
+     * modèle rechargé de façon transparente à la prochaine génération.
+     */
+    public class ResidencyManager : Object {
+        private const uint CHECK_INTERVAL_SECONDS = 15;
+        // Inactivité minimale avant de suspendre le modèle sous pression
+        private const int PRESSURE_SUSPEND_IDLE_SECONDS = 30;
+        private const int CRITICAL_SUSPEND_IDLE_SECONDS = 5;
+
+        private ConfigManager config_manager;
+        private ModelManager model_manager;
+        private MemoryMonitor? memory_monitor = null;
+        private uint check_timeout_id = 0;
+
+        public ResidencyManager(ConfigManager config_manager, ModelManager model_manager) {
+            this.config_manager = config_manager;
+            this.model_manager = model_manager;
+
+            if (!config_manager.get_boolean("Memory", "residency_enabled", true)) {
+                return;
+            }
+
+            memory_monitor = MemoryMonitor.dup_default();
+            memory_monitor.low_memory_warning.connect(on_low_memory_warning);
+
+            check_timeout_id = Timeout.add_seconds(CHECK_INTERVAL_SECONDS, () => {
+                check_residency();
+                return Source.CONTINUE;
+            });
+        }
+
+        ~ResidencyManager() {
+            if (check_timeout_id != 0) {
+                Source.remove(check_timeout_id);
+            }
+        }
+
+        /**
+         * Alerte du système : cache KV au niveau bas, modèle au-delà
+         */
+        private void on_low_memory_warning(MemoryMonitorWarningLevel level) {
+            stderr.printf("[PERF] RESIDENCY: Alerte mémoire du système (niveau %d), %lld Mo disponibles\n",
+                (int) level, read_available_memory_mb());
+
+            if (!model_manager.is_model_ready()) {
+                return;
+            }
+
+            if (level >= MemoryMonitorWarningLevel.MEDIUM && model_manager.is_model_resident()) {
+                int min_idle = level >= MemoryMonitorWarningLevel.CRITICAL
+                    ? CRITICAL_SUSPEND_IDLE_SECONDS : PRESSURE_SUSPEND_IDLE_SECONDS;
+                model_manager.release_memory(true, min_idle);
+            } else if (model_manager.has_kv_cache()) {
+                model_manager.release_memory(false, 0);
+            }
+        }
+
+        /**
+         * Vérification périodique de la mémoire disponible et de l'inactivité
+         */
+        private void check_residency() {
+            if (!model_manager.is_model_ready() || model_manager.is_in_simulation_mode()) {
+                return;
+            }
+
+            int64 idle_seconds = GenerationScheduler.get_instance().get_idle_time() / 1000000;
+            int64 available_mb = read_available_memory_mb();
+            int min_available_mb = config_manager.get_integer("Memory", "min_available_mb", 1024);
+
+            if (available_mb >= 0 && available_mb < min_available_mb) {
+                // Sous pression : d'abord le cache KV, puis le modèle inactif
+                if (model_manager.has_kv_cache()) {
+                    stderr.printf("[PERF] RESIDENCY: %lld Mo disponibles (< %d), libération du cache KV\n",
+                        available_mb, min_available_mb);
+                    model_manager.release_memory(false, 0);
+                } else if (model_manager.is_model_resident() && idle_seconds >= PRESSURE_SUSPEND_IDLE_SECONDS) {
+                    stderr.printf("[PERF] RESIDENCY: %lld Mo disponibles (< %d), suspension du modèle inactif depuis %lld s\n",
+                        available_mb, min_available_mb, idle_seconds);
+                    model_manager.release_memory(true, PRESSURE_SUSPEND_IDLE_SECONDS);
+                }
+                return;
+            }
+
+            // Sans pression : délais d'inactivité configurables (0 = jamais)
+            int kv_idle_seconds = config_manager.get_integer("Memory", "kv_idle_seconds", 300);
+            int model_idle_seconds = config_manager.get_integer("Memory", "model_idle_seconds", 1800);
+
+            if (model_idle_seconds > 0 && idle_seconds >= model_idle_seconds && model_manager.is_model_resident()) {
+                stderr.printf("[PERF] RESIDENCY: Modèle inactif depuis %lld s, suspension\n", idle_seconds);
+                model_manager.release_memory(true, model_idle_seconds);
+            } else if (kv_idle_seconds > 0 && idle_seconds >= kv_idle_seconds && model_manager.has_kv_cache()) {
+                stderr.printf("[PERF] RESIDENCY: Cache KV inactif depuis %lld s, libération\n", idle_seconds);
+                model_manager.release_memory(false, kv_idle_seconds);
+            }
+        }
+
+        /**
+         * Mémoire disponible en Mo d'après /proc/meminfo, -1 si inconnue
+         */
+        private int64 read_available_memory_mb() {
+            string contents;
+            try {
+                FileUtils.get_contents("/proc/meminfo", out contents);
+            } catch (Error e) {
+                return -1;
+            }
+
+            foreach (var line in contents.split("\n")) {
+                if (line.has_prefix("MemAvailable:")) {
+                    // Format : "MemAvailable:   12345678 kB"
+                    var fields = line.substring("MemAvailable:".length).strip().split(" ");
+                    return int64.parse(fields[0]) / 1024;
+                }
+            }
+            return -1;
+        }
+    }
+}
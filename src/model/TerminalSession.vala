@@ -0,0 +1,299 @@
+namespace Sambo {
+    /**
+     * Exécution réelle des commandes du terminal intégré
+     *
+     * Chaque commande est lancée via /bin/sh dans le répertoire courant de la
+     * session, dans son propre groupe de processus : les signaux atteignent
+     * aussi les commandes d'un pipeline ou lancées en arrière-plan. La sortie
+     * (stdout et stderr fusionnés) est lue de façon asynchrone sur le thread
+     * principal, sans jamais bloquer la boucle d'événements, et transmise par
+     * morceaux via output_received.
+     *
+     * La commande est terminée quand le shell se termine : si un processus
+     * resté en arrière-plan garde la sortie ouverte, la lecture est abandonnée
+     * après DRAIN_TIMEOUT_MS.
+     */
+    public class TerminalSession : Object {
+        private const size_t READ_CHUNK_SIZE = 16 * 1024;
+        private const uint DRAIN_TIMEOUT_MS = 200;
+
+        private Subprocess? process = null;
+        private int process_group = 0;
+        private Cancellable? read_cancellable = null;
+        private bool output_closed = false;
+        private bool process_exited = false;
+        private int exit_status = -1;
+        private int interrupt_count = 0;
+        private uint drain_timeout_id = 0;
+        private bool output_abandoned = false;
+        // Groupes des commandes terminées dont des processus tournaient encore
+        private Gee.ArrayList<int> lingering_groups = new Gee.ArrayList<int>();
+        // Octets d'un caractère UTF-8 coupé entre deux lectures
+        private ByteArray partial_char = new ByteArray();
+
+        public string working_directory { get; private set; }
+
+        /**
+         * Émis pour chaque morceau de sortie (texte UTF-8 valide)
+         */
+        public signal void output_received(string text);
+
+        /**
+         * Émis quand la commande se termine
+         */
+        public signal void command_finished(int exit_status);
+
+        public TerminalSession() {
+            working_directory = Environment.get_home_dir();
+        }
+
+        public bool is_running() {
+            return process != null;
+        }
+
+        /**
+         * Change le répertoire courant (commande interne cd)
+         * @return Un message d'erreur, ou null en cas de succès
+         */
+        public string? change_directory(string target) {
+            string path = target.strip();
+            if (path == "" || path == "~") {
+                path = Environment.get_home_dir();
+            } else if (path.has_prefix("~/")) {
+                path = Path.build_filename(Environment.get_home_dir(), path.substring(2));
+            } else if (!Path.is_absolute(path)) {
+                path = Path.build_filename(working_directory, path);
+            }
+
+            path = File.new_for_path(path).get_path();
+            if (!FileUtils.test(path, FileTest.IS_DIR)) {
+                return "cd: %s: Aucun dossier de ce type".printf(target);
+            }
+            working_directory = path;
+            return null;
+        }
+
+        /**
+         * Lance une commande ; la sortie arrive ensuite par output_received
+         */
+        public bool run(string command) {
+            if (process != null) {
+                return false;
+            }
+
+            try {
+                var launcher = new SubprocessLauncher(
+                    SubprocessFlags.STDIN_PIPE | SubprocessFlags.STDOUT_PIPE | SubprocessFlags.STDERR_MERGE);
+                launcher.set_cwd(working_directory);
+                launcher.setenv("TERM", "dumb", true);
+                launcher.set_child_setup(() => {
+                    Posix.setpgid(0, 0);
+                });
+                process = launcher.spawnv({ "/bin/sh", "-c", command });
+            } catch (Error e) {
+                output_received("Erreur lors du lancement : %s\n".printf(e.message));
+                command_finished(-1);
+                return false;
+            }
+
+            process_group = int.parse(process.get_identifier());
+            read_cancellable = new Cancellable();
+            partial_char.set_size(0);
+            output_closed = false;
+            output_abandoned = false;
+            process_exited = false;
+            exit_status = -1;
+            interrupt_count = 0;
+            read_output.begin(process, read_cancellable);
+            wait_process.begin(process);
+            return true;
+        }
+
+        /**
+         * Transmet une ligne saisie sur l'entrée standard de la commande en cours
+         */
+        public void send_input(string line) {
+            if (process == null) {
+                return;
+            }
+            var stdin_pipe = process.get_stdin_pipe();
+            stdin_pipe.write_all_async.begin((line + "\n").data, Priority.DEFAULT, null, (obj, res) => {
+                try {
+                    size_t written;
+                    stdin_pipe.write_all_async.end(res, out written);
+                } catch (Error e) {
+                    // La commande a pu fermer son entrée : rien à faire
+                }
+            });
+        }
+
+        /**
+         * Signale la fin de l'entrée standard à la commande en cours (Ctrl+D)
+         */
+        public void close_input() {
+            if (process == null) {
+                return;
+            }
+            try {
+                process.get_stdin_pipe().close(null);
+            } catch (Error e) {
+                // Entrée déjà fermée ou écriture en cours : rien à faire
+            }
+        }
+
+        /**
+         * Interrompt la commande en cours (Ctrl+C)
+         *
+         * Les appuis suivants envoient SIGTERM puis SIGKILL, pour les
+         * commandes qui ignorent SIGINT.
+         */
+        public void interrupt() {
+            if (process == null) {
+                return;
+            }
+            interrupt_count++;
+            if (interrupt_count == 1) {
+                signal_group(Posix.Signal.INT);
+            } else if (interrupt_count == 2) {
+                signal_group(Posix.Signal.TERM);
+            } else {
+                signal_group(Posix.Signal.KILL);
+            }
+        }
+
+        /**
+         * Termine la commande en cours et tout son groupe de processus, ainsi
+         * que ceux laissés en arrière-plan par les commandes précédentes
+         */
+        public void terminate() {
+            if (process != null) {
+                signal_group(Posix.Signal.KILL);
+            }
+            foreach (int group in lingering_groups) {
+                Posix.kill((Posix.pid_t) (-group), Posix.Signal.KILL);
+            }
+            lingering_groups.clear();
+            if (read_cancellable != null) {
+                read_cancellable.cancel();
+            }
+        }
+
+        private void signal_group(int signum) {
+            if (process_group > 0) {
+                Posix.kill((Posix.pid_t) (-process_group), signum);
+            }
+        }
+
+        private async void read_output(Subprocess proc, Cancellable cancellable) {
+            var stdout_pipe = proc.get_stdout_pipe();
+            try {
+                while (true) {
+                    var bytes = yield stdout_pipe.read_bytes_async(READ_CHUNK_SIZE, Priority.DEFAULT, cancellable);
+                    if (bytes.get_size() == 0) {
+                        break;
+                    }
+                    emit_chunk(bytes.get_data());
+                }
+            } catch (Error e) {
+                if (!(e is IOError.CANCELLED)) {
+                    output_received("Erreur de lecture : %s\n".printf(e.message));
+                }
+            }
+
+            if (proc == process) {
+                output_closed = true;
+                finish_if_done();
+            }
+        }
+
+        /**
+         * Attend la fin du shell, indépendamment de la lecture de la sortie
+         */
+        private async void wait_process(Subprocess proc) {
+            int status = -1;
+            try {
+                yield proc.wait_async(null);
+                status = proc.get_if_exited() ? proc.get_exit_status() : 128 + proc.get_term_sig();
+            } catch (Error e) {
+                warning("Erreur lors de l'attente de la commande : %s", e.message);
+            }
+
+            if (proc != process) {
+                return;
+            }
+            exit_status = status;
+            process_exited = true;
+
+            if (!output_closed) {
+                // Lire ce qui est déjà écrit, puis ne plus attendre les processus d'arrière-plan
+                drain_timeout_id = Timeout.add(DRAIN_TIMEOUT_MS, () => {
+                    drain_timeout_id = 0;
+                    output_abandoned = true;
+                    if (read_cancellable != null) {
+                        read_cancellable.cancel();
+                    }
+                    return Source.REMOVE;
+                });
+            }
+            finish_if_done();
+        }
+
+        private void finish_if_done() {
+            if (!output_closed || !process_exited) {
+                return;
+            }
+            if (drain_timeout_id != 0) {
+                Source.remove(drain_timeout_id);
+                drain_timeout_id = 0;
+            }
+
+            if (partial_char.len > 0) {
+                output_received(((string) partial_char.data).make_valid((ssize_t) partial_char.len));
+                partial_char.set_size(0);
+            }
+
+            if (output_abandoned) {
+                lingering_groups.add(process_group);
+            }
+            process = null;
+            process_group = 0;
+            read_cancellable = null;
+            command_finished(exit_status);
+        }
+
+        /**
+         * Émet un morceau de sortie en gardant de côté un caractère UTF-8 incomplet
+         */
+        private void emit_chunk(uint8[] data) {
+            partial_char.append(data);
+            size_t length = partial_char.len;
+
+            // Reculer au début d'un éventuel caractère multi-octets incomplet
+            size_t cut = length;
+            size_t back = 0;
+            while (cut > 0 && back < 4 && (partial_char.data[cut - 1] & 0xC0) == 0x80) {
+                cut--;
+                back++;
+            }
+            if (cut > 0 && partial_char.data[cut - 1] >= 0xC0) {
+                uint8 lead = partial_char.data[cut - 1];
+                size_t expected = lead >= 0xF0 ? 4 : (lead >= 0xE0 ? 3 : 2);
+                if (back + 1 < expected) {
+                    cut--;
+                } else {
+                    cut = length;
+                }
+            } else {
+                cut = length;
+            }
+
+            if (cut == 0) {
+                return;
+            }
+
+            string text = ((string) partial_char.data).make_valid((ssize_t) cut);
+            partial_char.remove_range(0, (uint) cut);
+            output_received(text);
+        }
+    }
+}
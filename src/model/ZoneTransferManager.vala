@@ -70,26 +70,23 @@ namespace Sambo {
             }
 
             try {
-                // Essayer d'accéder au buffer du terminal pour extraction du contenu réel
+                string transcript = terminal_view.get_transcript().strip();
+                if (transcript == "") {
+                    return "";
+                }
+
                 var content = new StringBuilder();
                 content.append("# Historique du Terminal\n\n");
-                content.append("```bash\n");
-
-                // Note: Dans une implémentation complète, on accéderait au TextBuffer du TerminalView
-                // pour extraire tout l'historique des commandes et des sorties
-                content.append("# Simulation de l'historique du terminal\n");
-                content.append("sambo> help\n");
-                content.append("Commandes disponibles:\n");
-                content.append("  hello   - Affiche Hello World\n");
-                content.append("  help    - Affiche cette aide\n");
-                content.append("  clear   - Efface le terminal\n");
-                content.append("  date    - Affiche la date et l'heure actuelles\n");
-                content.append("  version - Affiche la version de l'application\n\n");
-                content.append("sambo> date\n");
-                content.append(new DateTime.now_local().format("%c") + "\n\n");
-                content.append("# ... autres commandes ...\n");
-
-                content.append("```\n\n");
+
+                // Allonger la clôture si la sortie contient elle-même des ```
+                string fence = "```";
+                while (transcript.contains(fence)) {
+                    fence += "`";
+                }
+                content.append(fence + "bash\n");
+                content.append(transcript);
+                content.append("\n");
+                content.append(fence + "\n\n");
                 content.append("*Historique extrait automatiquement*\n\n");
 
                 return content.str;
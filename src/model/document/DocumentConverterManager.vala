@@ -80,6 +80,17 @@ namespace Sambo.Document {
             throw new FileError.NOENT("Le fichier %s n'existe pas".printf(path));
         }
 
+        // Markdown : lecture directe du fichier projeté en mémoire, sans copie intégrale
+        if (path.has_suffix(".md")) {
+            return MarkdownStreamParser.parse_file(path);
+        }
+
+        // Pivot binaire : projeté en mémoire, nœuds décodés à la demande.
+        // Les anciens fichiers .pivot en JSON passent par le convertisseur.
+        if (path.has_suffix(".pivot") && PivotBinaryReader.is_binary_pivot(path)) {
+            return PivotBinaryReader.load_document(path);
+        }
+
         string content;
         FileUtils.get_contents(path, out content);
 
@@ -88,7 +99,7 @@ namespace Sambo.Document {
 
     public string save_pivot_to_file(PivotDocument pivot, string path) throws Error {
         if (path.has_suffix(".pivot")) {
-            FileUtils.set_contents(path, pivot_converter.from_pivot(pivot));
+            PivotBinaryWriter.save(pivot, path);
             return path;
         } else if (path.has_suffix(".md")) {
             FileUtils.set_contents(path, md_converter.from_pivot(pivot));
@@ -0,0 +1,308 @@
+using GLib;
+
+namespace Sambo.Document {
+    /**
+     * Analyseur Markdown en une seule passe
+     *
+     * Les lignes sont consommées une à une (depuis une chaîne, un flux ou un
+     * fichier projeté en mémoire) sans jamais construire de tableau de lignes.
+     * Chaque bloc terminé est ajouté au document et signalé par node_parsed,
+     * ce qui permet d'afficher un gros fichier au fil de la lecture.
+     */
+    public class MarkdownStreamParser : Object {
+        // Marqueurs inline, les marqueurs doubles avant les simples
+        private const string[] INLINE_MARKERS = { "**", "__", "~~", "*", "`" };
+
+        private PivotDocument document;
+
+        // État des blocs en cours
+        private StringBuilder para_buf = new StringBuilder();
+        private StringBuilder quote_buf = new StringBuilder();
+        private StringBuilder? code_buf = null;
+        private string code_lang = "";
+        private PivotList? current_list = null;
+
+        /**
+         * Émis pour chaque bloc terminé, dans l'ordre du document
+         */
+        public signal void node_parsed(PivotNode node);
+
+        public MarkdownStreamParser(PivotDocument document) {
+            this.document = document;
+        }
+
+        /**
+         * Analyse un contenu déjà en mémoire
+         */
+        public static PivotDocument parse_string(string content, string path) {
+            var parser = new MarkdownStreamParser(create_document(path));
+            int pos = 0;
+            int length = content.length;
+            while (pos < length) {
+                int end = content.index_of_char('\n', pos);
+                if (end == -1) {
+                    end = length;
+                }
+                parser.feed_line(content.substring(pos, end - pos));
+                pos = end + 1;
+            }
+            return parser.finish();
+        }
+
+        /**
+         * Analyse un flux, ligne par ligne, sans le charger entièrement
+         */
+        public static PivotDocument parse_stream(InputStream stream, string path, Cancellable? cancellable = null) throws Error {
+            var parser = new MarkdownStreamParser(create_document(path));
+            var dis = new DataInputStream(stream);
+            dis.set_buffer_size(64 * 1024);
+            dis.set_newline_type(DataStreamNewlineType.ANY);
+
+            string? line;
+            while ((line = dis.read_line_utf8(null, cancellable)) != null) {
+                parser.feed_line(line);
+            }
+            return parser.finish();
+        }
+
+        /**
+         * Analyse un fichier projeté en mémoire : seules les lignes sont copiées
+         */
+        public static PivotDocument parse_file(string path) throws Error {
+            var mapped = new MappedFile(path, false);
+            var parser = new MarkdownStreamParser(create_document(path));
+
+            size_t length = mapped.get_length();
+            if (length > 0) {
+                var bytes = mapped.get_bytes();
+                unowned uint8[] data = bytes.get_data();
+                if (!((string) data).validate((ssize_t) length)) {
+                    throw new ConvertError.ILLEGAL_SEQUENCE("Le fichier %s n'est pas en UTF-8 valide", path);
+                }
+
+                size_t start = 0;
+                for (size_t i = 0; i <= length; i++) {
+                    if (i == length || data[i] == '\n') {
+                        if (i > start || i < length) {
+                            parser.feed_line(((string) ((char*) data + start)).ndup(i - start));
+                        }
+                        start = i + 1;
+                    }
+                }
+            }
+            return parser.finish();
+        }
+
+        private static PivotDocument create_document(string path) {
+            var pivot = new PivotDocument();
+            pivot.source_path = path;
+            pivot.source_format = "md";
+            return pivot;
+        }
+
+        /**
+         * Consomme une ligne (sans son saut de ligne)
+         */
+        public void feed_line(string line) {
+            string raw = line.has_suffix("\r") ? line.substring(0, line.length - 1) : line;
+            string t = raw.strip();
+
+            // Contenu d'un bloc de code
+            if (code_buf != null) {
+                if (t == "```") {
+                    emit(new PivotCodeBlock() { language = code_lang, code = code_buf.str });
+                    code_buf = null;
+                } else {
+                    code_buf.append(raw);
+                    code_buf.append_c('\n');
+                }
+                return;
+            }
+
+            // Début de bloc de code
+            if (t.has_prefix("```")) {
+                flush_blocks();
+                code_lang = t.substring(3).strip();
+                code_buf = new StringBuilder();
+                return;
+            }
+
+            // Vide -> fin du bloc courant
+            if (t == "") {
+                flush_blocks();
+                return;
+            }
+
+            // Métadonnées de style écrites par from_pivot
+            if (t.has_prefix("<!--") && t.contains("font:")) {
+                parse_style_metadata(t);
+                return;
+            }
+
+            // Titre
+            if (t[0] == '#') {
+                int level = 0;
+                while (level < t.length && t[level] == '#') level++;
+                if (level <= 6 && t.length > level && t[level] == ' ') {
+                    flush_blocks();
+                    emit(new PivotHeading() { level = level, text = t.substring(level).strip() });
+                    return;
+                }
+            }
+
+            // Citation : les lignes consécutives forment une seule citation
+            if (t[0] == '>') {
+                flush_paragraph();
+                flush_list();
+                if (quote_buf.len > 0) quote_buf.append_c(' ');
+                quote_buf.append(t.substring(1).strip());
+                return;
+            }
+
+            // Liste non ordonnée : les puces consécutives forment une seule liste
+            if (t.has_prefix("* ") || t.has_prefix("- ") || t.has_prefix("+ ")) {
+                flush_paragraph();
+                flush_quote();
+                if (current_list == null) {
+                    current_list = new PivotList() { ordered = false };
+                }
+                current_list.items.add(new PivotListItem() { text = t.substring(2).strip() });
+                return;
+            }
+
+            // Texte standard
+            flush_quote();
+            flush_list();
+            para_buf.append(raw);
+            para_buf.append_c('\n');
+        }
+
+        /**
+         * Termine l'analyse et retourne le document
+         */
+        public PivotDocument finish() {
+            if (code_buf != null) {
+                emit(new PivotCodeBlock() { language = code_lang, code = code_buf.str });
+                code_buf = null;
+            }
+            flush_blocks();
+            return document;
+        }
+
+        private void emit(PivotNode node) {
+            document.children.add(node);
+            node_parsed(node);
+        }
+
+        private void flush_blocks() {
+            flush_paragraph();
+            flush_quote();
+            flush_list();
+        }
+
+        private void flush_paragraph() {
+            if (para_buf.len == 0) {
+                return;
+            }
+            string text = para_buf.str.strip();
+            para_buf.truncate(0);
+            if (text.length > 0) {
+                var para = new PivotParagraph();
+                para.segments = parse_inline(text);
+                emit(para);
+            }
+        }
+
+        private void flush_quote() {
+            if (quote_buf.len > 0) {
+                emit(new PivotQuote() { text = quote_buf.str });
+                quote_buf.truncate(0);
+            }
+        }
+
+        private void flush_list() {
+            if (current_list != null) {
+                emit(current_list);
+                current_list = null;
+            }
+        }
+
+        private void parse_style_metadata(string t) {
+            var meta = t.replace("<!--", "").replace("-->", "").strip();
+            foreach (string part in meta.split(";")) {
+                var kv = part.strip().split(":");
+                if (kv.length == 2) {
+                    string key = kv[0].strip();
+                    string val = kv[1].strip();
+                    if (key == "font") document.meta_font_family = val;
+                    else if (key == "size") document.meta_font_size = int.parse(val);
+                    else if (key == "color") document.meta_font_color = val;
+                }
+            }
+        }
+
+        /**
+         * Découpe un paragraphe en segments formatés en un seul parcours
+         *
+         * Même sémantique que l'ancien analyseur : un marqueur ouvrant sans
+         * marqueur fermant laisse le reste du texte brut.
+         */
+        public static Gee.List<TextSegment> parse_inline(string text) {
+            var segments = new Gee.ArrayList<TextSegment>();
+            int length = text.length;
+            int plain_start = 0;
+            int i = 0;
+
+            while (i < length) {
+                char c = text[i];
+                if (c != '*' && c != '_' && c != '~' && c != '`') {
+                    i++;
+                    continue;
+                }
+
+                // Identifier le marqueur à cette position
+                string? marker = null;
+                foreach (unowned string m in INLINE_MARKERS) {
+                    if (text[i] == m[0] && (m.length == 1 || (i + 1 < length && text[i + 1] == m[1]))) {
+                        marker = m;
+                        break;
+                    }
+                }
+                if (marker == null) {
+                    i++;
+                    continue;
+                }
+
+                int close = text.index_of(marker, i + marker.length);
+                if (close == -1) {
+                    // Pas de fin de marqueur : le reste est du texte brut
+                    break;
+                }
+
+                if (i > plain_start) {
+                    segments.add(new TextSegment(text.substring(plain_start, i - plain_start)));
+                }
+                int inner_start = i + marker.length;
+                segments.add(new TextSegment(text.substring(inner_start, close - inner_start), marker_format(marker).to_flag()));
+
+                i = close + marker.length;
+                plain_start = i;
+            }
+
+            if (plain_start < length) {
+                segments.add(new TextSegment(text.substring(plain_start)));
+            }
+            return segments;
+        }
+
+        private static TextFormatting marker_format(string marker) {
+            switch (marker) {
+                case "**": return TextFormatting.BOLD;
+                case "__": return TextFormatting.UNDERLINE;
+                case "~~": return TextFormatting.STRIKETHROUGH;
+                case "`": return TextFormatting.CODE;
+                default: return TextFormatting.ITALIC;
+            }
+        }
+    }
+}
@@ -0,0 +1,583 @@
+using GLib;
+using Gee;
+
+namespace Sambo.Document {
+    /*
+     * Format binaire .pivot (version 1), entiers fixes en big-endian :
+     *
+     *   0  "SPIV" | version:uint8 | réservé:3
+     *   8  offset de l'index des chaînes:uint64 | nombre de chaînes:uint32
+     *  20  offset de l'index des nœuds:uint64   | nombre de nœuds:uint32
+     *  32  métadonnées du document
+     *      enregistrements de nœuds (varints, chaînes par numéro dans la table)
+     *      chaînes : [longueur:varint][octets UTF-8]
+     *      index des chaînes : offset:uint64 par chaîne
+     *      index des nœuds   : offset:uint64 par nœud
+     *
+     * Les index sont en fin de fichier : on peut ajouter des nœuds en réécrivant
+     * seulement la fin, sans toucher aux enregistrements existants. Le JSON de
+     * PivotDocument.serialize reste le format d'échange.
+     */
+
+    /**
+     * Écrit un PivotDocument au format binaire
+     */
+    public class PivotBinaryWriter : Object {
+        internal const string MAGIC = "SPIV";
+        internal const uint8 VERSION = 1;
+        internal const int HEADER_SIZE = 32;
+
+        internal const uint8 NODE_PARAGRAPH = 1;
+        internal const uint8 NODE_HEADING = 2;
+        internal const uint8 NODE_LIST = 3;
+        internal const uint8 NODE_LIST_ITEM = 4;
+        internal const uint8 NODE_CODE_BLOCK = 5;
+        internal const uint8 NODE_QUOTE = 6;
+        internal const uint8 NODE_IMAGE = 7;
+        internal const uint8 NODE_LINK = 8;
+        internal const uint8 NODE_TABLE = 9;
+
+        internal const uint META_FONT_FAMILY = 1 << 0;
+        internal const uint META_FONT_SIZE = 1 << 1;
+        internal const uint META_FONT_COLOR = 1 << 2;
+
+        private MemoryOutputStream body_stream;
+        private DataOutputStream body;
+        private HashMap<string, uint> string_ids = new HashMap<string, uint>();
+        private Gee.ArrayList<string> strings = new Gee.ArrayList<string>();
+
+        private PivotBinaryWriter() {
+            body_stream = new MemoryOutputStream.resizable();
+            body = new DataOutputStream(body_stream);
+            body.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+        }
+
+        /**
+         * Sauvegarde le document au format binaire (écriture atomique)
+         */
+        public static void save(PivotDocument pivot, string path) throws Error {
+            var data = encode(pivot);
+            FileUtils.set_data(path, data.get_data());
+        }
+
+        /**
+         * Encode le document complet
+         */
+        public static Bytes encode(PivotDocument pivot) throws Error {
+            var writer = new PivotBinaryWriter();
+            return writer.write_document(pivot);
+        }
+
+        private Bytes write_document(PivotDocument pivot) throws Error {
+            // Métadonnées
+            put_string_ref(pivot.source_format ?? "pivot");
+            uint meta_flags = 0;
+            if (pivot.meta_font_family != null) meta_flags |= META_FONT_FAMILY;
+            if (pivot.meta_font_size != null) meta_flags |= META_FONT_SIZE;
+            if (pivot.meta_font_color != null) meta_flags |= META_FONT_COLOR;
+            put_varint(meta_flags);
+            if (pivot.meta_font_family != null) put_string_ref(pivot.meta_font_family);
+            if (pivot.meta_font_size != null) put_varint((uint64) pivot.meta_font_size);
+            if (pivot.meta_font_color != null) put_string_ref(pivot.meta_font_color);
+
+            // Nœuds
+            var node_offsets = new uint64[pivot.children.size];
+            int n = 0;
+            foreach (var node in pivot.children) {
+                node_offsets[n++] = position();
+                write_node(node);
+            }
+
+            // Chaînes
+            var string_offsets = new uint64[strings.size];
+            for (int i = 0; i < strings.size; i++) {
+                string_offsets[i] = position();
+                unowned string s = strings[i];
+                put_varint((uint64) s.length);
+                body.put_string(s);
+            }
+
+            uint64 string_index_offset = position();
+            foreach (var offset in string_offsets) {
+                body.put_uint64(offset);
+            }
+            uint64 node_index_offset = position();
+            foreach (var offset in node_offsets) {
+                body.put_uint64(offset);
+            }
+            body.close();
+
+            // En-tête puis corps
+            var out_stream = new MemoryOutputStream.resizable();
+            var header = new DataOutputStream(out_stream);
+            header.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+            header.put_string(MAGIC);
+            header.put_byte(VERSION);
+            header.put_byte(0);
+            header.put_uint16(0);
+            header.put_uint64(string_index_offset);
+            header.put_uint32((uint32) strings.size);
+            header.put_uint64(node_index_offset);
+            header.put_uint32((uint32) node_offsets.length);
+
+            size_t written;
+            header.write_all(body_stream.steal_as_bytes().get_data(), out written);
+            header.close();
+            return out_stream.steal_as_bytes();
+        }
+
+        private void write_node(PivotNode node) throws Error {
+            if (node is PivotParagraph) {
+                var para = (PivotParagraph) node;
+                body.put_byte(NODE_PARAGRAPH);
+                put_varint((uint64) para.segments.size);
+                foreach (var segment in para.segments) {
+                    put_string_ref(segment.text ?? "");
+                    put_varint(segment.formats);
+                }
+            } else if (node is PivotHeading) {
+                var heading = (PivotHeading) node;
+                body.put_byte(NODE_HEADING);
+                put_varint((uint64) heading.level);
+                put_string_ref(heading.text ?? "");
+            } else if (node is PivotList) {
+                var list = (PivotList) node;
+                body.put_byte(NODE_LIST);
+                put_varint(list.ordered ? 1 : 0);
+                put_varint((uint64) list.items.size);
+                foreach (var item in list.items) {
+                    put_string_ref(item.text ?? "");
+                }
+            } else if (node is PivotListItem) {
+                body.put_byte(NODE_LIST_ITEM);
+                put_string_ref(((PivotListItem) node).text ?? "");
+            } else if (node is PivotCodeBlock) {
+                var block = (PivotCodeBlock) node;
+                body.put_byte(NODE_CODE_BLOCK);
+                put_string_ref(block.language ?? "");
+                put_string_ref(block.code ?? "");
+            } else if (node is PivotQuote) {
+                body.put_byte(NODE_QUOTE);
+                put_string_ref(((PivotQuote) node).text ?? "");
+            } else if (node is PivotImage) {
+                var img = (PivotImage) node;
+                body.put_byte(NODE_IMAGE);
+                put_string_ref(img.src ?? "");
+                put_string_ref(img.alt ?? "");
+            } else if (node is PivotLink) {
+                var link = (PivotLink) node;
+                body.put_byte(NODE_LINK);
+                put_string_ref(link.href ?? "");
+                put_string_ref(link.text ?? "");
+            } else if (node is PivotTable) {
+                var table = (PivotTable) node;
+                body.put_byte(NODE_TABLE);
+                put_varint((uint64) table.rows.size);
+                foreach (var row in table.rows) {
+                    put_varint((uint64) row.size);
+                    foreach (var cell in row) {
+                        put_string_ref(cell ?? "");
+                    }
+                }
+            } else {
+                // Type inconnu : conservé comme paragraphe Markdown
+                body.put_byte(NODE_PARAGRAPH);
+                put_varint(1);
+                put_string_ref(node.to_markdown());
+                put_varint(0);
+            }
+        }
+
+        private uint64 position() {
+            return HEADER_SIZE + body_stream.get_data_size();
+        }
+
+        private void put_varint(uint64 value) throws Error {
+            while (value >= 0x80) {
+                body.put_byte((uint8) ((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            body.put_byte((uint8) value);
+        }
+
+        private void put_string_ref(string value) throws Error {
+            uint id;
+            if (string_ids.has_key(value)) {
+                id = string_ids[value];
+            } else {
+                id = strings.size;
+                strings.add(value);
+                string_ids[value] = id;
+            }
+            put_varint(id);
+        }
+    }
+
+    /**
+     * Lecteur du format binaire, sur un fichier projeté en mémoire
+     *
+     * Aucun nœud n'est décodé à l'ouverture : decode_node() lit un
+     * enregistrement à la demande grâce à l'index des nœuds.
+     */
+    public class PivotBinaryReader : Object {
+        private MappedFile mapped;
+        private Bytes bytes;
+        private uint64 string_index_offset;
+        private uint string_count;
+        private uint64 node_index_offset;
+
+        public uint node_count { get; private set; }
+
+        /**
+         * Vérifie si le fichier commence par la signature du format binaire
+         */
+        public static bool is_binary_pivot(string path) {
+            try {
+                var stream = File.new_for_path(path).read();
+                uint8[] magic = new uint8[4];
+                size_t read;
+                stream.read_all(magic, out read);
+                stream.close();
+                return read == 4 && Memory.cmp(magic, PivotBinaryWriter.MAGIC.data, 4) == 0;
+            } catch (Error e) {
+                return false;
+            }
+        }
+
+        /**
+         * Ouvre un fichier .pivot binaire ; les nœuds sont chargés paresseusement
+         */
+        public static PivotDocument load_document(string path) throws Error {
+            var reader = new PivotBinaryReader(path);
+            var pivot = new PivotDocument();
+            reader.read_metadata(pivot);
+            pivot.source_path = path;
+            pivot.children = new LazyPivotNodeList(reader);
+            return pivot;
+        }
+
+        public PivotBinaryReader(string path) throws Error {
+            mapped = new MappedFile(path, false);
+            bytes = mapped.get_bytes();
+            unowned uint8[] data = bytes.get_data();
+
+            if (data.length < PivotBinaryWriter.HEADER_SIZE ||
+                Memory.cmp(data, PivotBinaryWriter.MAGIC.data, 4) != 0) {
+                throw new Error(Quark.from_string("PivotFormatError"), 4, "Not a binary pivot file: %s", path);
+            }
+            if (data[4] > PivotBinaryWriter.VERSION) {
+                throw new Error(Quark.from_string("PivotFormatError"), 5, "Unsupported binary pivot version: %u", data[4]);
+            }
+
+            string_index_offset = read_u64_at(8);
+            string_count = (uint) read_u32_at(16);
+            node_index_offset = read_u64_at(20);
+            node_count = (uint) read_u32_at(28);
+
+            if (string_index_offset + (uint64) string_count * 8 > data.length ||
+                node_index_offset + (uint64) node_count * 8 > data.length) {
+                throw new Error(Quark.from_string("PivotFormatError"), 6, "Truncated binary pivot file: %s", path);
+            }
+        }
+
+        private void read_metadata(PivotDocument pivot) throws Error {
+            size_t pos = PivotBinaryWriter.HEADER_SIZE;
+            pivot.source_format = read_string_ref(ref pos);
+            uint flags = (uint) read_varint(ref pos);
+            if ((flags & PivotBinaryWriter.META_FONT_FAMILY) != 0) pivot.meta_font_family = read_string_ref(ref pos);
+            if ((flags & PivotBinaryWriter.META_FONT_SIZE) != 0) pivot.meta_font_size = (int) read_varint(ref pos);
+            if ((flags & PivotBinaryWriter.META_FONT_COLOR) != 0) pivot.meta_font_color = read_string_ref(ref pos);
+        }
+
+        /**
+         * Décode le nœud d'indice index
+         */
+        public PivotNode decode_node(uint index) throws Error {
+            if (index >= node_count) {
+                throw new Error(Quark.from_string("PivotFormatError"), 7, "Node index out of range: %u", index);
+            }
+            size_t pos = (size_t) read_u64_at((size_t) (node_index_offset + (uint64) index * 8));
+            uint8 type = read_byte(ref pos);
+
+            switch (type) {
+                case PivotBinaryWriter.NODE_PARAGRAPH:
+                    var para = new PivotParagraph();
+                    uint n_segments = (uint) read_varint(ref pos);
+                    for (uint i = 0; i < n_segments; i++) {
+                        string text = read_string_ref(ref pos);
+                        para.segments.add(new TextSegment(text, (uint) read_varint(ref pos)));
+                    }
+                    return para;
+                case PivotBinaryWriter.NODE_HEADING:
+                    var heading = new PivotHeading();
+                    heading.level = (int) read_varint(ref pos);
+                    heading.text = read_string_ref(ref pos);
+                    return heading;
+                case PivotBinaryWriter.NODE_LIST:
+                    var list = new PivotList();
+                    list.ordered = read_varint(ref pos) != 0;
+                    uint n_items = (uint) read_varint(ref pos);
+                    for (uint i = 0; i < n_items; i++) {
+                        list.items.add(new PivotListItem() { text = read_string_ref(ref pos) });
+                    }
+                    return list;
+                case PivotBinaryWriter.NODE_LIST_ITEM:
+                    return new PivotListItem() { text = read_string_ref(ref pos) };
+                case PivotBinaryWriter.NODE_CODE_BLOCK:
+                    var block = new PivotCodeBlock();
+                    block.language = read_string_ref(ref pos);
+                    block.code = read_string_ref(ref pos);
+                    return block;
+                case PivotBinaryWriter.NODE_QUOTE:
+                    return new PivotQuote() { text = read_string_ref(ref pos) };
+                case PivotBinaryWriter.NODE_IMAGE:
+                    var img = new PivotImage();
+                    img.src = read_string_ref(ref pos);
+                    img.alt = read_string_ref(ref pos);
+                    return img;
+                case PivotBinaryWriter.NODE_LINK:
+                    var link = new PivotLink();
+                    link.href = read_string_ref(ref pos);
+                    link.text = read_string_ref(ref pos);
+                    return link;
+                case PivotBinaryWriter.NODE_TABLE:
+                    var table = new PivotTable();
+                    uint n_rows = (uint) read_varint(ref pos);
+                    for (uint r = 0; r < n_rows; r++) {
+                        var row = new Gee.ArrayList<string>();
+                        uint n_cells = (uint) read_varint(ref pos);
+                        for (uint c = 0; c < n_cells; c++) {
+                            row.add(read_string_ref(ref pos));
+                        }
+                        table.rows.add(row);
+                    }
+                    return table;
+                default:
+                    throw new Error(Quark.from_string("PivotFormatError"), 1, "Unknown binary node type: %u", type);
+            }
+        }
+
+        private string read_string_ref(ref size_t pos) throws Error {
+            uint id = (uint) read_varint(ref pos);
+            if (id >= string_count) {
+                throw new Error(Quark.from_string("PivotFormatError"), 8, "String index out of range: %u", id);
+            }
+            size_t str_pos = (size_t) read_u64_at((size_t) (string_index_offset + (uint64) id * 8));
+            size_t length = (size_t) read_varint(ref str_pos);
+
+            unowned uint8[] data = bytes.get_data();
+            if (str_pos + length > data.length) {
+                throw new Error(Quark.from_string("PivotFormatError"), 6, "Truncated string in binary pivot");
+            }
+            return ((string) ((char*) data + str_pos)).ndup(length);
+        }
+
+        private uint8 read_byte(ref size_t pos) throws Error {
+            unowned uint8[] data = bytes.get_data();
+            if (pos >= data.length) {
+                throw new Error(Quark.from_string("PivotFormatError"), 6, "Truncated binary pivot record");
+            }
+            return data[pos++];
+        }
+
+        private uint64 read_varint(ref size_t pos) throws Error {
+            uint64 value = 0;
+            int shift = 0;
+            while (shift < 64) {
+                uint8 b = read_byte(ref pos);
+                value |= ((uint64) (b & 0x7F)) << shift;
+                if ((b & 0x80) == 0) {
+                    return value;
+                }
+                shift += 7;
+            }
+            throw new Error(Quark.from_string("PivotFormatError"), 9, "Malformed varint in binary pivot");
+        }
+
+        private uint64 read_u64_at(size_t pos) {
+            unowned uint8[] data = bytes.get_data();
+            uint64 value = 0;
+            for (int i = 0; i < 8; i++) {
+                value = (value << 8) | data[pos + i];
+            }
+            return value;
+        }
+
+        private uint32 read_u32_at(size_t pos) {
+            unowned uint8[] data = bytes.get_data();
+            return ((uint32) data[pos] << 24) | ((uint32) data[pos + 1] << 16) |
+                   ((uint32) data[pos + 2] << 8) | (uint32) data[pos + 3];
+        }
+    }
+
+    /**
+     * Liste des enfants d'un document binaire, décodés à la première lecture
+     *
+     * Les nœuds décodés sont conservés pour que les modifications en place
+     * soient vues par tous. Toute modification de la liste elle-même la
+     * matérialise entièrement en ArrayList.
+     */
+    public class LazyPivotNodeList : Gee.AbstractList<PivotNode> {
+        private PivotBinaryReader reader;
+        private HashMap<int, PivotNode> decoded = new HashMap<int, PivotNode>();
+        private Gee.ArrayList<PivotNode>? materialized = null;
+
+        public LazyPivotNodeList(PivotBinaryReader reader) {
+            this.reader = reader;
+        }
+
+        public override int size {
+            get { return materialized != null ? materialized.size : (int) reader.node_count; }
+        }
+
+        public override bool read_only {
+            get { return false; }
+        }
+
+        public override PivotNode get(int index) {
+            if (materialized != null) {
+                return materialized[index];
+            }
+            if (decoded.has_key(index)) {
+                return decoded[index];
+            }
+
+            PivotNode node;
+            try {
+                node = reader.decode_node(index);
+            } catch (Error e) {
+                warning("Failed to decode binary pivot node %d: %s", index, e.message);
+                node = new PivotParagraph() { text = "" };
+            }
+            decoded[index] = node;
+            return node;
+        }
+
+        public override void set(int index, PivotNode item) {
+            materialize().set(index, item);
+        }
+
+        public override int index_of(PivotNode item) {
+            if (materialized != null) {
+                return materialized.index_of(item);
+            }
+            // Un nœud jamais décodé ne peut pas être celui recherché
+            int found = -1;
+            foreach (var entry in decoded.entries) {
+                if (entry.value == item && (found == -1 || entry.key < found)) {
+                    found = entry.key;
+                }
+            }
+            return found;
+        }
+
+        public override void insert(int index, PivotNode item) {
+            materialize().insert(index, item);
+        }
+
+        public override PivotNode remove_at(int index) {
+            return materialize().remove_at(index);
+        }
+
+        public override Gee.List<PivotNode>? slice(int start, int stop) {
+            var result = new Gee.ArrayList<PivotNode>();
+            for (int i = start; i < stop; i++) {
+                result.add(get(i));
+            }
+            return result;
+        }
+
+        public override Gee.ListIterator<PivotNode> list_iterator() {
+            return materialize().list_iterator();
+        }
+
+        public override Gee.Iterator<PivotNode> iterator() {
+            if (materialized != null) {
+                return materialized.iterator();
+            }
+            return new LazyIterator(this);
+        }
+
+        public override bool contains(PivotNode item) {
+            return index_of(item) >= 0;
+        }
+
+        public override bool add(PivotNode item) {
+            return materialize().add(item);
+        }
+
+        public override bool remove(PivotNode item) {
+            return materialize().remove(item);
+        }
+
+        public override void clear() {
+            materialized = new Gee.ArrayList<PivotNode>();
+            decoded.clear();
+        }
+
+        private Gee.ArrayList<PivotNode> materialize() {
+            if (materialized == null) {
+                var list = new Gee.ArrayList<PivotNode>();
+                int count = (int) reader.node_count;
+                for (int i = 0; i < count; i++) {
+                    list.add(get(i));
+                }
+                materialized = list;
+                decoded.clear();
+            }
+            return materialized;
+        }
+
+        /**
+         * Itérateur en lecture seule qui décode au fil du parcours
+         */
+        private class LazyIterator : Object, Traversable<PivotNode>, Gee.Iterator<PivotNode> {
+            private LazyPivotNodeList list;
+            private int index = -1;
+
+            public LazyIterator(LazyPivotNodeList list) {
+                this.list = list;
+            }
+
+            public bool next() {
+                if (index + 1 < list.size) {
+                    index++;
+                    return true;
+                }
+                return false;
+            }
+
+            public bool has_next() {
+                return index + 1 < list.size;
+            }
+
+            public new PivotNode get() {
+                return list.get(index);
+            }
+
+            public void remove() {
+                assert_not_reached();
+            }
+
+            public bool valid {
+                get { return index >= 0 && index < list.size; }
+            }
+
+            public bool read_only {
+                get { return true; }
+            }
+
+            public new bool foreach(ForallFunc<PivotNode> f) {
+                if (valid && !f(get())) {
+                    return false;
+                }
+                while (next()) {
+                    if (!f(get())) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+    }
+}
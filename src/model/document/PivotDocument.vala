@@ -22,6 +22,16 @@ namespace Sambo.Document {
                 default: throw new Error(Quark.from_string("PivotFormatError"), 0, "Invalid TextFormatting string: %s".printf(s));
             }
         }
+
+        // Bit correspondant dans le masque de formats d'un TextSegment
+        public uint to_flag() {
+            return 1u << (uint) this;
+        }
+
+        // Liste de toutes les valeurs, pour parcourir un masque
+        public static TextFormatting[] all() {
+            return { BOLD, ITALIC, UNDERLINE, STRIKETHROUGH, CODE };
+        }
     }
 
     // Spécifier GLib.Object pour éviter l'ambiguïté
@@ -209,15 +219,20 @@ namespace Sambo.Document {
     // Spécifier GLib.Object
     public class TextSegment : GLib.Object {
         public string text;
-        public Gee.HashSet<TextFormatting> formats;
+        // Formats actifs sous forme de masque de bits (voir TextFormatting.to_flag)
+        public uint formats;
 
-        public TextSegment(string text, Gee.HashSet<TextFormatting>? formats = null) {
+        public TextSegment(string text, uint formats = 0) {
             this.text = text;
-            this.formats = formats != null ? formats : new Gee.HashSet<TextFormatting>();
+            this.formats = formats;
         }
 
         public bool has_format(TextFormatting fmt) {
-            return formats.contains(fmt);
+            return (formats & fmt.to_flag()) != 0;
+        }
+
+        public void add_format(TextFormatting fmt) {
+            formats |= fmt.to_flag();
         }
 
         public string to_markdown() {
@@ -234,8 +249,10 @@ namespace Sambo.Document {
             var obj = new Json.Object();
             obj.set_string_member("text", text ?? "");
             var formats_array = new Json.Array();
-            foreach (var format in formats) {
-                formats_array.add_string_element(format.to_string());
+            foreach (var format in TextFormatting.all()) {
+                if (has_format(format)) {
+                    formats_array.add_string_element(format.to_string());
+                }
             }
             obj.set_array_member("formats", formats_array);
             return obj;
@@ -253,7 +270,7 @@ namespace Sambo.Document {
                     if (format_node.get_node_type() == Json.NodeType.VALUE) {
                         try {
                             // Utiliser la méthode parse ajoutée à l'enum
-                            segment.formats.add(TextFormatting.parse(format_node.get_string()));
+                            segment.add_format(TextFormatting.parse(format_node.get_string()));
                         } catch (Error e) {
                             warning("Failed to parse text formatting: %s", e.message);
                         }
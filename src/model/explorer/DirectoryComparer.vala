@@ -0,0 +1,273 @@
+namespace Sambo {
+    /**
+     * Résultat de la comparaison d'une entrée entre deux arborescences
+     */
+    public enum ComparisonStatus {
+        IDENTICAL,
+        DIFFERENT,
+        ONLY_LEFT,
+        ONLY_RIGHT
+    }
+
+    /**
+     * Entrée comparée, identifiée par son chemin relatif aux deux racines
+     */
+    public class ComparisonEntry : Object {
+        public string relative_path { get; construct; }
+        public FileItemModel? left { get; construct; }
+        public FileItemModel? right { get; construct; }
+        public ComparisonStatus status { get; construct; }
+
+        public ComparisonEntry(string relative_path, FileItemModel? left, FileItemModel? right, ComparisonStatus status) {
+            Object(relative_path: relative_path, left: left, right: right, status: status);
+        }
+    }
+
+    /**
+     * Comparaison récursive de deux répertoires sur un pool de threads
+     *
+     * Chaque sous-répertoire et chaque paire de fichiers de même taille est une
+     * tâche du pool. Une taille différente suffit à conclure ; sinon une
+     * empreinte partielle (début et fin) puis, si besoin, complète est comparée,
+     * via FileHashCache. Les résultats sont regroupés et émis par lots sur le
+     * thread principal au fil du calcul.
+     */
+    public class DirectoryComparer : Object {
+        private const string QUERY_ATTRIBUTES = "standard::*,time::modified,time::modified-usec,unix::mode,unix::inode,unix::device";
+        private const uint FLUSH_INTERVAL_MS = 50;
+
+        // Pool partagé : une tâche garde une référence sur son comparateur, pas l'inverse
+        private static ThreadPool<CompareJob>? pool = null;
+
+        private class CompareJob {
+            public DirectoryComparer comparer;
+            public string relative_path;
+            public FileInfo? left_info;
+            public FileInfo? right_info;
+
+            public CompareJob(DirectoryComparer comparer, string relative_path, FileInfo? left_info = null, FileInfo? right_info = null) {
+                this.comparer = comparer;
+                this.relative_path = relative_path;
+                this.left_info = left_info;
+                this.right_info = right_info;
+            }
+        }
+
+        public string left_root { get; construct; }
+        public string right_root { get; construct; }
+
+        private Cancellable cancellable = new Cancellable();
+        private FileHashCache hash_cache;
+        private int pending_jobs = 0;
+
+        // Résultats en attente d'émission sur le thread principal
+        private Mutex pending_mutex = Mutex();
+        private Gee.ArrayList<ComparisonEntry> pending_entries = new Gee.ArrayList<ComparisonEntry>();
+        private bool flush_scheduled = false;
+
+        /**
+         * Émis sur le thread principal avec chaque lot de résultats
+         */
+        public signal void entries_found(Gee.List<ComparisonEntry> entries);
+
+        /**
+         * Émis sur le thread principal quand toutes les tâches sont terminées
+         */
+        public signal void comparison_finished(bool cancelled);
+
+        public DirectoryComparer(string left_root, string right_root) {
+            Object(left_root: left_root, right_root: right_root);
+        }
+
+        /**
+         * Lance la comparaison (à appeler depuis le thread principal)
+         */
+        public void start() {
+            hash_cache = FileHashCache.get_instance();
+
+            if (pool == null) {
+                try {
+                    pool = new ThreadPool<CompareJob>.with_owned_data((job) => {
+                        job.comparer.run_job(job);
+                    }, (int) get_num_processors(), false);
+                } catch (ThreadError e) {
+                    warning("Impossible de créer le pool de comparaison: %s", e.message);
+                    comparison_finished(true);
+                    return;
+                }
+            }
+
+            stderr.printf("[PERF] DIRECTORYCOMPARER: Comparaison de %s et %s\n", left_root, right_root);
+            push_job(new CompareJob(this, ""));
+        }
+
+        /**
+         * Annule la comparaison ; les tâches en cours s'arrêtent au plus tôt
+         */
+        public void cancel() {
+            cancellable.cancel();
+        }
+
+        private void push_job(CompareJob job) {
+            AtomicInt.inc(ref pending_jobs);
+            try {
+                pool.add(job);
+            } catch (ThreadError e) {
+                warning("Erreur lors de l'ajout d'une tâche de comparaison: %s", e.message);
+                job_done();
+            }
+        }
+
+        private void run_job(CompareJob job) {
+            if (!cancellable.is_cancelled()) {
+                if (job.left_info == null) {
+                    compare_directory(job.relative_path);
+                } else {
+                    compare_files(job.relative_path, job.left_info, job.right_info);
+                }
+            }
+            job_done();
+        }
+
+        private void job_done() {
+            if (AtomicInt.dec_and_test(ref pending_jobs)) {
+                hash_cache.save();
+                Idle.add(() => {
+                    flush_entries();
+                    stderr.printf("[PERF] DIRECTORYCOMPARER: Comparaison %s\n",
+                        cancellable.is_cancelled() ? "annulée" : "terminée");
+                    comparison_finished(cancellable.is_cancelled());
+                    return Source.REMOVE;
+                });
+            }
+        }
+
+        /**
+         * Compare le contenu d'un répertoire présent des deux côtés
+         */
+        private void compare_directory(string relative_path) {
+            var left_children = list_directory(Path.build_filename(left_root, relative_path));
+            var right_children = list_directory(Path.build_filename(right_root, relative_path));
+
+            foreach (var item in left_children.entries) {
+                string child_path = relative_path == "" ? item.key : Path.build_filename(relative_path, item.key);
+                var left_info = item.value;
+                var right_info = right_children[item.key];
+
+                if (right_info == null) {
+                    add_entry(child_path, left_info, null, ComparisonStatus.ONLY_LEFT);
+                    continue;
+                }
+
+                bool left_dir = left_info.get_file_type() == FileType.DIRECTORY;
+                bool right_dir = right_info.get_file_type() == FileType.DIRECTORY;
+
+                if (left_dir && right_dir) {
+                    push_job(new CompareJob(this, child_path));
+                } else if (left_dir != right_dir || left_info.get_size() != right_info.get_size()) {
+                    add_entry(child_path, left_info, right_info, ComparisonStatus.DIFFERENT);
+                } else {
+                    push_job(new CompareJob(this, child_path, left_info, right_info));
+                }
+            }
+
+            foreach (var item in right_children.entries) {
+                if (!left_children.has_key(item.key)) {
+                    string child_path = relative_path == "" ? item.key : Path.build_filename(relative_path, item.key);
+                    add_entry(child_path, null, item.value, ComparisonStatus.ONLY_RIGHT);
+                }
+            }
+        }
+
+        /**
+         * Compare deux fichiers de même taille : inode, puis empreinte partielle, puis complète
+         */
+        private void compare_files(string relative_path, FileInfo left_info, FileInfo right_info) {
+            string left_file = Path.build_filename(left_root, relative_path);
+            string right_file = Path.build_filename(right_root, relative_path);
+            var status = ComparisonStatus.DIFFERENT;
+
+            try {
+                if (is_same_inode(left_info, right_info) || left_info.get_size() == 0) {
+                    status = ComparisonStatus.IDENTICAL;
+                } else if (hash_cache.get_partial_hash(left_file, left_info, cancellable) ==
+                           hash_cache.get_partial_hash(right_file, right_info, cancellable)) {
+                    if (left_info.get_size() <= FileHashCache.PARTIAL_WINDOW * 2 ||
+                        hash_cache.get_full_hash(left_file, left_info, cancellable) ==
+                        hash_cache.get_full_hash(right_file, right_info, cancellable)) {
+                        status = ComparisonStatus.IDENTICAL;
+                    }
+                }
+            } catch (Error e) {
+                if (e is IOError.CANCELLED) {
+                    return;
+                }
+                warning("Erreur lors de la comparaison de %s: %s", relative_path, e.message);
+            }
+
+            add_entry(relative_path, left_info, right_info, status);
+        }
+
+        private static bool is_same_inode(FileInfo a, FileInfo b) {
+            return a.has_attribute(FileAttribute.UNIX_INODE) && b.has_attribute(FileAttribute.UNIX_INODE) &&
+                   a.get_attribute_uint64(FileAttribute.UNIX_INODE) == b.get_attribute_uint64(FileAttribute.UNIX_INODE) &&
+                   a.get_attribute_uint32(FileAttribute.UNIX_DEVICE) == b.get_attribute_uint32(FileAttribute.UNIX_DEVICE);
+        }
+
+        private Gee.HashMap<string, FileInfo> list_directory(string path) {
+            var children = new Gee.HashMap<string, FileInfo>();
+            try {
+                var enumerator = File.new_for_path(path).enumerate_children(
+                    QUERY_ATTRIBUTES, FileQueryInfoFlags.NOFOLLOW_SYMLINKS, cancellable);
+                FileInfo info;
+                while ((info = enumerator.next_file(cancellable)) != null) {
+                    children[info.get_name()] = info;
+                }
+                enumerator.close();
+            } catch (Error e) {
+                if (!(e is IOError.CANCELLED)) {
+                    warning("Erreur lors de la lecture de %s: %s", path, e.message);
+                }
+            }
+            return children;
+        }
+
+        /**
+         * Ajoute un résultat au lot courant et planifie son émission
+         */
+        private void add_entry(string relative_path, FileInfo? left_info, FileInfo? right_info, ComparisonStatus status) {
+            FileItemModel? left = null;
+            FileItemModel? right = null;
+            if (left_info != null) {
+                left = new FileItemModel.from_file_info(Path.build_filename(left_root, relative_path), left_info);
+            }
+            if (right_info != null) {
+                right = new FileItemModel.from_file_info(Path.build_filename(right_root, relative_path), right_info);
+            }
+            var entry = new ComparisonEntry(relative_path, left, right, status);
+
+            pending_mutex.lock();
+            pending_entries.add(entry);
+            if (!flush_scheduled) {
+                flush_scheduled = true;
+                Timeout.add(FLUSH_INTERVAL_MS, () => {
+                    flush_entries();
+                    return Source.REMOVE;
+                });
+            }
+            pending_mutex.unlock();
+        }
+
+        private void flush_entries() {
+            pending_mutex.lock();
+            var batch = pending_entries;
+            pending_entries = new Gee.ArrayList<ComparisonEntry>();
+            flush_scheduled = false;
+            pending_mutex.unlock();
+
+            if (batch.size > 0 && !cancellable.is_cancelled()) {
+                entries_found(batch);
+            }
+        }
+    }
+}
@@ -0,0 +1,401 @@
+namespace Sambo {
+    /**
+     * Implémentation incrémentale de XXH64 (hash rapide non cryptographique)
+     */
+    public class XxHash64 : Object {
+        private const uint64 PRIME1 = 0x9E3779B185EBCA87ULL;
+        private const uint64 PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+        private const uint64 PRIME3 = 0x165667B19E3779F9ULL;
+        private const uint64 PRIME4 = 0x85EBCA77C2B2AE63ULL;
+        private const uint64 PRIME5 = 0x27D4EB2F165667C5ULL;
+
+        private uint64 seed;
+        private uint64 v1;
+        private uint64 v2;
+        private uint64 v3;
+        private uint64 v4;
+        private uint64 total_len = 0;
+        private uint8 mem[32];
+        private size_t mem_size = 0;
+
+        public XxHash64(uint64 seed = 0) {
+            this.seed = seed;
+            v1 = seed + PRIME1 + PRIME2;
+            v2 = seed + PRIME2;
+            v3 = seed;
+            v4 = seed - PRIME1;
+        }
+
+        /**
+         * Ajoute des données au hash
+         */
+        public void update(uint8* input, size_t length) {
+            total_len += length;
+            uint8* buffer = (uint8*) mem;
+
+            if (mem_size + length < 32) {
+                Memory.copy(buffer + mem_size, input, length);
+                mem_size += length;
+                return;
+            }
+
+            size_t pos = 0;
+            if (mem_size > 0) {
+                size_t fill = 32 - mem_size;
+                Memory.copy(buffer + mem_size, input, fill);
+                consume_stripe(buffer);
+                pos = fill;
+                mem_size = 0;
+            }
+
+            while (pos + 32 <= length) {
+                consume_stripe(input + pos);
+                pos += 32;
+            }
+
+            if (pos < length) {
+                mem_size = length - pos;
+                Memory.copy(buffer, input + pos, mem_size);
+            }
+        }
+
+        /**
+         * Retourne le hash des données ajoutées jusqu'ici
+         */
+        public uint64 digest() {
+            uint64 h;
+            if (total_len >= 32) {
+                h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+                h = merge_round(h, v1);
+                h = merge_round(h, v2);
+                h = merge_round(h, v3);
+                h = merge_round(h, v4);
+            } else {
+                h = seed + PRIME5;
+            }
+            h += total_len;
+
+            uint8* p = (uint8*) mem;
+            size_t pos = 0;
+            while (pos + 8 <= mem_size) {
+                h ^= round(0, read64(p + pos));
+                h = rotl(h, 27) * PRIME1 + PRIME4;
+                pos += 8;
+            }
+            if (pos + 4 <= mem_size) {
+                h ^= (uint64) read32(p + pos) * PRIME1;
+                h = rotl(h, 23) * PRIME2 + PRIME3;
+                pos += 4;
+            }
+            while (pos < mem_size) {
+                h ^= (uint64) p[pos] * PRIME5;
+                h = rotl(h, 11) * PRIME1;
+                pos++;
+            }
+
+            h ^= h >> 33;
+            h *= PRIME2;
+            h ^= h >> 29;
+            h *= PRIME3;
+            h ^= h >> 32;
+            return h;
+        }
+
+        private void consume_stripe(uint8* p) {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+
+        private static uint64 round(uint64 acc, uint64 input) {
+            acc += input * PRIME2;
+            acc = rotl(acc, 31);
+            return acc * PRIME1;
+        }
+
+        private static uint64 merge_round(uint64 acc, uint64 val) {
+            acc ^= round(0, val);
+            return acc * PRIME1 + PRIME4;
+        }
+
+        private static uint64 rotl(uint64 x, int r) {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        private static uint64 read64(uint8* p) {
+            uint64 value = 0;
+            Memory.copy(&value, p, 8);
+            return uint64.from_little_endian(value);
+        }
+
+        private static uint32 read32(uint8* p) {
+            uint32 value = 0;
+            Memory.copy(&value, p, 4);
+            return uint32.from_little_endian(value);
+        }
+    }
+
+    /**
+     * Cache persistant des empreintes de fichiers
+     *
+     * Les entrées sont indexées par périphérique/inode (ou par chemin à défaut)
+     * et restent valides tant que la taille et la date de modification ne
+     * changent pas. Deux empreintes sont gardées : partielle (début et fin du
+     * fichier) et complète, calculée seulement quand la partielle ne suffit pas.
+     * Les méthodes de calcul peuvent être appelées depuis plusieurs threads.
+     */
+    public class FileHashCache : Object {
+        private const string CACHE_MAGIC = "SAMBOHSH";
+        private const uint8 CACHE_VERSION = 1;
+        private const int MAX_ENTRIES = 100000;
+        private const size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+        // Taille lue au début et à la fin du fichier pour l'empreinte partielle
+        public const int64 PARTIAL_WINDOW = 64 * 1024;
+
+        private static FileHashCache? instance = null;
+
+        private class Entry {
+            public int64 size;
+            public int64 mtime_us;
+            public bool has_partial = false;
+            public uint64 partial = 0;
+            public bool has_full = false;
+            public uint64 full = 0;
+            public bool touched = false;
+        }
+
+        private Gee.HashMap<string, Entry> entries = new Gee.HashMap<string, Entry>();
+        private Mutex mutex = Mutex();
+        private bool dirty = false;
+        private string cache_path;
+
+        /**
+         * Retourne l'instance unique (à obtenir depuis le thread principal)
+         */
+        public static FileHashCache get_instance() {
+            if (instance == null) {
+                instance = new FileHashCache();
+            }
+            return instance;
+        }
+
+        private FileHashCache() {
+            cache_path = Path.build_filename(Environment.get_user_config_dir(), "sambo", "file-hashes.cache");
+            load();
+        }
+
+        /**
+         * Empreinte du début et de la fin du fichier
+         *
+         * Pour un fichier de moins de deux fenêtres, elle couvre tout le contenu
+         * et sert aussi d'empreinte complète.
+         */
+        public uint64 get_partial_hash(string path, FileInfo info, Cancellable? cancellable = null) throws Error {
+            string key = make_key(path, info);
+            int64 size = info.get_size();
+            int64 mtime_us = get_mtime_us(info);
+
+            mutex.lock();
+            var entry = lookup(key, size, mtime_us);
+            if (entry.has_partial) {
+                uint64 cached = entry.partial;
+                mutex.unlock();
+                return cached;
+            }
+            mutex.unlock();
+
+            var hasher = new XxHash64();
+            var stream = File.new_for_path(path).read(cancellable);
+            var buffer = new uint8[(int) PARTIAL_WINDOW];
+            size_t bytes_read;
+
+            if (size <= PARTIAL_WINDOW * 2) {
+                hash_stream(stream, hasher, cancellable);
+            } else {
+                stream.read_all(buffer, out bytes_read, cancellable);
+                hasher.update((uint8*) buffer, bytes_read);
+                stream.seek(size - PARTIAL_WINDOW, SeekType.SET, cancellable);
+                stream.read_all(buffer, out bytes_read, cancellable);
+                hasher.update((uint8*) buffer, bytes_read);
+            }
+            stream.close();
+            uint64 hash = hasher.digest();
+
+            mutex.lock();
+            entry.has_partial = true;
+            entry.partial = hash;
+            if (size <= PARTIAL_WINDOW * 2) {
+                entry.has_full = true;
+                entry.full = hash;
+            }
+            dirty = true;
+            mutex.unlock();
+            return hash;
+        }
+
+        /**
+         * Empreinte de tout le contenu du fichier
+         */
+        public uint64 get_full_hash(string path, FileInfo info, Cancellable? cancellable = null) throws Error {
+            string key = make_key(path, info);
+            int64 size = info.get_size();
+            int64 mtime_us = get_mtime_us(info);
+
+            mutex.lock();
+            var entry = lookup(key, size, mtime_us);
+            if (entry.has_full) {
+                uint64 cached = entry.full;
+                mutex.unlock();
+                return cached;
+            }
+            mutex.unlock();
+
+            var hasher = new XxHash64();
+            var stream = File.new_for_path(path).read(cancellable);
+            hash_stream(stream, hasher, cancellable);
+            stream.close();
+            uint64 hash = hasher.digest();
+
+            mutex.lock();
+            entry.has_full = true;
+            entry.full = hash;
+            dirty = true;
+            mutex.unlock();
+            return hash;
+        }
+
+        private void hash_stream(InputStream stream, XxHash64 hasher, Cancellable? cancellable) throws Error {
+            var buffer = new uint8[READ_BUFFER_SIZE];
+            ssize_t n;
+            while ((n = stream.read(buffer, cancellable)) > 0) {
+                hasher.update((uint8*) buffer, (size_t) n);
+            }
+        }
+
+        /**
+         * Retourne l'entrée valide pour cette clé, en la réinitialisant si le fichier a changé
+         * (appelée sous verrou)
+         */
+        private Entry lookup(string key, int64 size, int64 mtime_us) {
+            var entry = entries[key];
+            if (entry == null || entry.size != size || entry.mtime_us != mtime_us) {
+                entry = new Entry();
+                entry.size = size;
+                entry.mtime_us = mtime_us;
+                entries[key] = entry;
+            }
+            entry.touched = true;
+            return entry;
+        }
+
+        private static string make_key(string path, FileInfo info) {
+            if (info.has_attribute(FileAttribute.UNIX_INODE) && info.has_attribute(FileAttribute.UNIX_DEVICE)) {
+                return "%u:%llu".printf(info.get_attribute_uint32(FileAttribute.UNIX_DEVICE),
+                                        info.get_attribute_uint64(FileAttribute.UNIX_INODE));
+            }
+            return path;
+        }
+
+        private static int64 get_mtime_us(FileInfo info) {
+            var mtime = info.get_modification_date_time();
+            if (mtime == null) {
+                return 0;
+            }
+            return mtime.to_unix() * 1000000 + mtime.get_microsecond();
+        }
+
+        /**
+         * Écrit le cache sur disque s'il a changé
+         */
+        public void save() {
+            mutex.lock();
+            if (!dirty) {
+                mutex.unlock();
+                return;
+            }
+
+            try {
+                var stream = new MemoryOutputStream.resizable();
+                var dos = new DataOutputStream(stream);
+                dos.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+                dos.put_string(CACHE_MAGIC);
+                dos.put_byte(CACHE_VERSION);
+
+                // Au-delà de la limite, seules les entrées utilisées pendant la session sont gardées
+                bool prune = entries.size > MAX_ENTRIES;
+                int count = 0;
+                foreach (var entry in entries.values) {
+                    if (!prune || entry.touched) count++;
+                }
+                dos.put_uint32((uint32) count);
+
+                foreach (var item in entries.entries) {
+                    var entry = item.value;
+                    if (prune && !entry.touched) continue;
+                    dos.put_uint16((uint16) item.key.length);
+                    dos.put_string(item.key);
+                    dos.put_int64(entry.size);
+                    dos.put_int64(entry.mtime_us);
+                    dos.put_byte((entry.has_partial ? 1 : 0) | (entry.has_full ? 2 : 0));
+                    dos.put_uint64(entry.partial);
+                    dos.put_uint64(entry.full);
+                }
+                dos.close();
+
+                DirUtils.create_with_parents(Path.get_dirname(cache_path), 0755);
+                FileUtils.set_data(cache_path, stream.steal_as_bytes().get_data());
+                dirty = false;
+            } catch (Error e) {
+                warning("Erreur lors de la sauvegarde du cache d'empreintes: %s", e.message);
+            }
+            mutex.unlock();
+        }
+
+        private void load() {
+            var file = File.new_for_path(cache_path);
+            if (!file.query_exists()) {
+                return;
+            }
+
+            try {
+                var dis = new DataInputStream(new BufferedInputStream(file.read()));
+                dis.set_byte_order(DataStreamByteOrder.BIG_ENDIAN);
+
+                uint8[] magic = new uint8[CACHE_MAGIC.length];
+                size_t magic_read;
+                dis.read_all(magic, out magic_read);
+                if (magic_read != CACHE_MAGIC.length || Memory.cmp(magic, CACHE_MAGIC.data, CACHE_MAGIC.length) != 0 ||
+                    dis.read_byte() != CACHE_VERSION) {
+                    stderr.printf("[WARNING] FILEHASHCACHE: Cache d'empreintes invalide ignoré\n");
+                    return;
+                }
+
+                uint32 count = dis.read_uint32();
+                for (uint32 i = 0; i < count; i++) {
+                    uint16 key_length = dis.read_uint16();
+                    uint8[] key_data = new uint8[key_length + 1];
+                    key_data.length = key_length;
+                    size_t key_read;
+                    dis.read_all(key_data, out key_read);
+
+                    var entry = new Entry();
+                    entry.size = dis.read_int64();
+                    entry.mtime_us = dis.read_int64();
+                    uint8 flags = dis.read_byte();
+                    entry.has_partial = (flags & 1) != 0;
+                    entry.has_full = (flags & 2) != 0;
+                    entry.partial = dis.read_uint64();
+                    entry.full = dis.read_uint64();
+                    entries[(string) key_data] = entry;
+                }
+                dis.close();
+
+                stderr.printf("[PERF] FILEHASHCACHE: %d empreintes chargées\n", entries.size);
+            } catch (Error e) {
+                warning("Erreur lors du chargement du cache d'empreintes: %s", e.message);
+            }
+        }
+    }
+}
@@ -2,14 +2,24 @@
 #include <thread>
 #include <cstdlib>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <map>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
 
 // Inclure les headers de llama.cpp
 #ifdef HAVE_LLAMA_CPP
 #include "llama.h"
 #include "ggml.h"
+#include "gguf.h"
 #endif
 
 // Variables globales pour gérer l'état de llama.cpp
@@ -18,10 +28,410 @@ static llama_model* g_model = nullptr;
 static llama_context* g_context = nullptr;
 static bool g_backend_initialized = false;
 static volatile bool g_generation_stopped = false;
+// Le contexte est partagé (chat, serveur local) : une seule génération à la fois
+static std::mutex g_context_mutex;
+// Tokens présents dans le cache KV (séquence 0), pour réutiliser le préfixe commun
+static std::vector<llama_token> g_cached_tokens;
+// Adaptateurs LoRA chargés pour le modèle courant, gardés résidents (libérés avec le modèle)
+static std::map<std::string, llama_adapter_lora*> g_lora_cache;
+// Adaptateurs attachés au contexte, avec leur échelle
+static std::vector<std::pair<llama_adapter_lora*, float>> g_active_loras;
+// Modèle courant ; suspendu, il est libéré puis rechargé à la prochaine utilisation
+static std::string g_model_path;
+static bool g_model_suspended = false;
+static std::vector<std::pair<std::string, float>> g_resume_loras;
+// État de session (cache KV) sauvegardé sur disque à la libération du contexte
+static std::string g_state_path;
+
+// Charge un adaptateur LoRA s'il n'est pas déjà résident (verrou du contexte tenu)
+static llama_adapter_lora* sambo_get_lora_locked(const std::string& path) {
+    auto it = g_lora_cache.find(path);
+    if (it != g_lora_cache.end()) {
+        return it->second;
+    }
+
+    gint64 start = g_get_monotonic_time();
+    llama_adapter_lora* adapter = llama_adapter_lora_init(g_model, path.c_str());
+    if (!adapter) {
+        g_warning("Failed to load LoRA adapter: %s", path.c_str());
+        return nullptr;
+    }
+    g_lora_cache[path] = adapter;
+    g_debug("LoRA adapter loaded in %.1f ms: %s", (g_get_monotonic_time() - start) / 1000.0, path.c_str());
+    return adapter;
+}
+
+// Réglages du contexte : taille, précision du cache KV, flash attention
+struct SamboContextConfig {
+    gint n_ctx;
+    gint kv_cache_type;
+    bool flash_attention;
+    gint n_seq_max;
+
+    bool operator==(const SamboContextConfig& other) const {
+        return n_ctx == other.n_ctx && kv_cache_type == other.kv_cache_type &&
+               flash_attention == other.flash_attention && n_seq_max == other.n_seq_max;
+    }
+
+    // Un contexte prévu pour plus de séquences convient aussi
+    bool satisfies(const SamboContextConfig& wanted) const {
+        return n_ctx == wanted.n_ctx && kv_cache_type == wanted.kv_cache_type &&
+               flash_attention == wanted.flash_attention && n_seq_max >= wanted.n_seq_max;
+    }
+};
+
+// Réglages du contexte actuel, et ceux à utiliser au prochain chargement
+static SamboContextConfig g_context_config = { 2048, SAMBO_KV_CACHE_F16, false, 1 };
+static SamboContextConfig g_load_context_config = { 2048, SAMBO_KV_CACHE_F16, false, 1 };
+static std::mutex g_load_config_mutex;
+static SamboContextConfig g_state_config = { 2048, SAMBO_KV_CACHE_F16, false, 1 };
+
+static void sambo_drop_saved_state() {
+    if (!g_state_path.empty()) {
+        g_remove(g_state_path.c_str());
+        g_state_path.clear();
+    }
+}
+
+static llama_model_params sambo_model_params() {
+    llama_model_params model_params = llama_model_default_params();
+    model_params.n_gpu_layers = 0; // CPU seulement pour l'instant
+    return model_params;
+}
+
+static SamboContextConfig sambo_make_context_config(gint n_ctx, gint kv_cache_type, gboolean flash_attention) {
+    SamboContextConfig config = { n_ctx > 0 ? n_ctx : 2048, kv_cache_type, flash_attention != FALSE, 1 };
+    return config;
+}
+
+static ggml_type sambo_kv_ggml_type(gint kv_cache_type) {
+    switch (kv_cache_type) {
+        case SAMBO_KV_CACHE_Q8_0: return GGML_TYPE_Q8_0;
+        case SAMBO_KV_CACHE_Q4_0: return GGML_TYPE_Q4_0;
+        default: return GGML_TYPE_F16;
+    }
+}
+
+// llama.cpp n'accepte un cache V quantifié qu'avec flash attention
+static ggml_type sambo_kv_value_type(const SamboContextConfig& config) {
+    return config.flash_attention ? sambo_kv_ggml_type(config.kv_cache_type) : GGML_TYPE_F16;
+}
+
+static const char* sambo_kv_type_name(gint kv_cache_type) {
+    return ggml_type_name(sambo_kv_ggml_type(kv_cache_type));
+}
+
+// Crée un contexte pour g_model (verrou du contexte tenu)
+static llama_context* sambo_create_context_locked(const SamboContextConfig& config) {
+    llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx = config.n_ctx;
+    ctx_params.n_threads = sambo_llama_get_optimal_threads();
+    ctx_params.n_threads_batch = ctx_params.n_threads;
+    ctx_params.type_k = sambo_kv_ggml_type(config.kv_cache_type);
+    ctx_params.type_v = sambo_kv_value_type(config);
+    ctx_params.flash_attn_type = config.flash_attention ? LLAMA_FLASH_ATTN_TYPE_ENABLED : LLAMA_FLASH_ATTN_TYPE_DISABLED;
+    // Séquences parallèles : les n_ctx cellules du cache KV sont partagées entre elles
+    ctx_params.n_seq_max = config.n_seq_max;
+    ctx_params.kv_unified = true;
+
+    if (config.kv_cache_type != SAMBO_KV_CACHE_F16 && !config.flash_attention) {
+        g_warning("KV cache %s without flash attention: only K is quantized", sambo_kv_type_name(config.kv_cache_type));
+    }
+
+    gint64 start = g_get_monotonic_time();
+    llama_context* context = llama_init_from_model(g_model, ctx_params);
+    if (context) {
+        g_debug("Context created in %.1f ms: n_ctx=%d, kv=%s, flash_attn=%s",
+                (g_get_monotonic_time() - start) / 1000.0, config.n_ctx,
+                sambo_kv_type_name(config.kv_cache_type), config.flash_attention ? "on" : "off");
+    }
+    return context;
+}
+
+// Restaure l'état de session sauvegardé si le contexte a les mêmes réglages (verrou tenu)
+static void sambo_restore_state_locked() {
+    if (g_state_path.empty()) {
+        return;
+    }
+
+    if (g_state_config == g_context_config) {
+        gint64 start = g_get_monotonic_time();
+        std::vector<llama_token> tokens(g_context_config.n_ctx);
+        size_t n_loaded = 0;
+        if (llama_state_load_file(g_context, g_state_path.c_str(), tokens.data(), tokens.size(), &n_loaded)) {
+            tokens.resize(n_loaded);
+            g_cached_tokens = tokens;
+            g_debug("Session state restored in %.1f ms: %zu tokens",
+                    (g_get_monotonic_time() - start) / 1000.0, n_loaded);
+        } else {
+            g_warning("Failed to restore session state: %s", g_state_path.c_str());
+            llama_memory_clear(llama_get_memory(g_context), true);
+            g_cached_tokens.clear();
+        }
+    }
+    sambo_drop_saved_state();
+}
+
+// Recrée le contexte si les réglages demandés diffèrent (verrou du contexte tenu).
+// Les adaptateurs LoRA attachés sont reportés sur le nouveau contexte.
+static bool sambo_ensure_context_locked(const SamboContextConfig& wanted) {
+    if (g_context && g_context_config.satisfies(wanted)) {
+        return true;
+    }
+
+    if (g_context) {
+        llama_free(g_context);
+        g_context = nullptr;
+    }
+    g_cached_tokens.clear();
+
+    bool applied = true;
+    g_context = sambo_create_context_locked(wanted);
+    if (g_context) {
+        g_context_config = wanted;
+    } else {
+        g_warning("Failed to create context (n_ctx=%d, kv=%s), restoring previous settings",
+                  wanted.n_ctx, sambo_kv_type_name(wanted.kv_cache_type));
+        g_context = sambo_create_context_locked(g_context_config);
+        applied = false;
+    }
+
+    if (g_context) {
+        for (const auto& entry : g_active_loras) {
+            llama_set_adapter_lora(g_context, entry.first, entry.second);
+        }
+        sambo_restore_state_locked();
+    }
+    return applied && g_context != nullptr;
+}
+
+// Sauvegarde l'état de session puis libère le contexte et son cache KV (verrou tenu)
+static void sambo_release_context_locked(const gchar* state_path) {
+    if (!g_context) {
+        return;
+    }
+
+    sambo_drop_saved_state();
+    if (state_path && !g_cached_tokens.empty()) {
+        gint64 start = g_get_monotonic_time();
+        if (llama_state_save_file(g_context, state_path, g_cached_tokens.data(), g_cached_tokens.size())) {
+            g_state_path = state_path;
+            g_state_config = g_context_config;
+            g_debug("Session state saved in %.1f ms: %zu tokens",
+                    (g_get_monotonic_time() - start) / 1000.0, g_cached_tokens.size());
+        } else {
+            g_warning("Failed to save session state: %s", state_path);
+        }
+    }
+
+    llama_free(g_context);
+    g_context = nullptr;
+    g_cached_tokens.clear();
+}
+
+// Recharge un modèle suspendu et ses adaptateurs (verrou tenu)
+static bool sambo_ensure_model_locked() {
+    if (g_model) {
+        return true;
+    }
+    if (!g_model_suspended) {
+        return false;
+    }
+
+    gint64 start = g_get_monotonic_time();
+    g_model = llama_model_load_from_file(g_model_path.c_str(), sambo_model_params());
+    if (!g_model) {
+        g_warning("Failed to resume model: %s", g_model_path.c_str());
+        return false;
+    }
+    g_model_suspended = false;
+
+    for (const auto& entry : g_resume_loras) {
+        llama_adapter_lora* adapter = sambo_get_lora_locked(entry.first);
+        if (adapter) {
+            g_active_loras.emplace_back(adapter, entry.second);
+        }
+    }
+    g_resume_loras.clear();
+
+    g_debug("Model resumed in %.1f ms: %s", (g_get_monotonic_time() - start) / 1000.0, g_model_path.c_str());
+    return true;
+}
+
+// Chaîne d'échantillonnage top-k / top-p / température
+static llama_sampler* sambo_create_sampler(const SamboSamplingParams* params, uint32_t seed) {
+    llama_sampler* sampler = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    llama_sampler_chain_add(sampler, llama_sampler_init_top_k(params ? params->top_k : 40));
+    llama_sampler_chain_add(sampler, llama_sampler_init_top_p(params ? params->top_p : 0.9f, 1));
+    llama_sampler_chain_add(sampler, llama_sampler_init_temp(params ? params->temperature : 0.7f));
+    llama_sampler_chain_add(sampler, llama_sampler_init_dist(seed));
+    return sampler;
+}
+
+static void sambo_batch_add(llama_batch& batch, llama_token token, llama_pos pos, llama_seq_id seq_id, bool logits) {
+    batch.token[batch.n_tokens] = token;
+    batch.pos[batch.n_tokens] = pos;
+    batch.n_seq_id[batch.n_tokens] = 1;
+    batch.seq_id[batch.n_tokens][0] = seq_id;
+    batch.logits[batch.n_tokens] = logits;
+    batch.n_tokens++;
+}
+
+// Lit un entier non signé dans les métadonnées GGUF
+static bool sambo_gguf_get_uint(const gguf_context* gguf, const std::string& key, uint64_t* value) {
+    int64_t id = gguf_find_key(gguf, key.c_str());
+    if (id < 0) {
+        return false;
+    }
+    switch (gguf_get_kv_type(gguf, id)) {
+        case GGUF_TYPE_UINT32: *value = gguf_get_val_u32(gguf, id); return true;
+        case GGUF_TYPE_INT32: *value = (uint64_t)gguf_get_val_i32(gguf, id); return true;
+        case GGUF_TYPE_UINT64: *value = gguf_get_val_u64(gguf, id); return true;
+        case GGUF_TYPE_INT64: *value = (uint64_t)gguf_get_val_i64(gguf, id); return true;
+        default: return false;
+    }
+}
 #endif
 
+// Source de tokens synthétique : remplace le modèle pour mesurer le pipeline
+// de streaming côté Vala à un débit réaliste, sans fichier GGUF ni llama.cpp
+struct SamboSyntheticConfig {
+    double tokens_per_second;
+    double rate_jitter;        // Variation relative de l'intervalle (0 = cadence fixe)
+    int min_token_chars;
+    double mean_token_chars;
+    int max_token_chars;
+};
+
+static std::atomic<bool> g_synthetic_enabled{false};
+static std::atomic<bool> g_synthetic_loaded{false};
+static std::atomic<bool> g_synthetic_stopped{false};
+static std::atomic<gint64> g_synthetic_emitted{0};
+static std::mutex g_synthetic_mutex;
+static SamboSyntheticConfig g_synthetic_config = { 50.0, 0.0, 1, 4.0, 12 };
+
+// Générateur de texte pseudo-Markdown : mots, ponctuation, gras, listes et
+// paragraphes, pour exercer le rendu des bulles comme une vraie réponse
+class SamboSyntheticText {
+public:
+    SamboSyntheticText(const SamboSyntheticConfig& config, uint32_t seed) : config_(config), rng_(seed) {}
+
+    std::string next_token() {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::string token;
+
+        if (tokens_ > 0 && tokens_ % 97 == 0) {
+            token = "\n\n";
+        } else if (tokens_ > 0 && tokens_ % 61 == 0) {
+            token = "\n- ";
+        } else if (tokens_ > 0 && tokens_ % 23 == 0) {
+            token = bold_open_ ? "**" : " **";
+            bold_open_ = !bold_open_;
+        }
+
+        // Longueur tirée selon une loi exponentielle bornée autour de la moyenne
+        double extra = -std::log(1.0 - unit(rng_)) * std::max(0.0, config_.mean_token_chars - config_.min_token_chars);
+        int length = std::min(config_.max_token_chars, config_.min_token_chars + (int)extra);
+
+        static const char* const accented[] = { "é", "è", "à", "ç", "ê" };
+        for (int i = 0; i < length; i++) {
+            double draw = unit(rng_);
+            if (word_length_ > 2 && draw < 0.18) {
+                token += (draw < 0.02) ? ". " : (draw < 0.04 ? ", " : " ");
+                word_length_ = 0;
+            } else if (draw > 0.97) {
+                token += accented[(int)(unit(rng_) * 5) % 5];
+                word_length_++;
+            } else {
+                token += (char)('a' + (int)(unit(rng_) * 26) % 26);
+                word_length_++;
+            }
+        }
+
+        tokens_++;
+        return token;
+    }
+
+    // Intervalle avant le prochain token, en microsecondes
+    gint64 next_interval_us() {
+        double base = 1e6 / std::max(0.1, config_.tokens_per_second);
+        if (config_.rate_jitter <= 0.0) {
+            return (gint64)base;
+        }
+        std::uniform_real_distribution<double> spread(-config_.rate_jitter, config_.rate_jitter);
+        return (gint64)std::max(0.0, base * (1.0 + spread(rng_)));
+    }
+
+private:
+    SamboSyntheticConfig config_;
+    std::mt19937 rng_;
+    int tokens_ = 0;
+    int word_length_ = 0;
+    bool bold_open_ = false;
+};
+
+// Émet max_tokens tokens synthétiques à la cadence configurée ; on_token
+// retourne false pour arrêter. Retourne le nombre de tokens émis.
+static int sambo_synthetic_run(const SamboSamplingParams* params, const std::function<bool(const std::string&)>& on_token) {
+    SamboSyntheticConfig config;
+    {
+        std::lock_guard<std::mutex> lock(g_synthetic_mutex);
+        config = g_synthetic_config;
+    }
+
+    uint32_t seed = (params && params->seed >= 0) ? (uint32_t)params->seed : std::random_device{}();
+    SamboSyntheticText text(config, seed);
+    const int max_tokens = params ? params->max_tokens : 512;
+
+    g_synthetic_stopped = false;
+    auto deadline = std::chrono::steady_clock::now();
+    int emitted = 0;
+    while (emitted < max_tokens && !g_synthetic_stopped) {
+        auto interval = std::chrono::microseconds(text.next_interval_us());
+        deadline += interval;
+        auto now = std::chrono::steady_clock::now();
+        if (deadline > now) {
+            std::this_thread::sleep_until(deadline);
+        } else if (now - deadline > interval) {
+            // Consommateur trop lent : ne pas rattraper le retard par rafale
+            deadline = now;
+        }
+
+        if (!on_token(text.next_token())) {
+            break;
+        }
+        emitted++;
+        g_synthetic_emitted++;
+    }
+    return emitted;
+}
+
 extern "C" {
 
+// Source de tokens synthétique
+void sambo_llama_set_synthetic_backend(gboolean enabled, gdouble tokens_per_second, gdouble rate_jitter,
+                                       gint min_token_chars, gdouble mean_token_chars, gint max_token_chars) {
+    {
+        std::lock_guard<std::mutex> lock(g_synthetic_mutex);
+        g_synthetic_config.tokens_per_second = tokens_per_second > 0 ? tokens_per_second : 50.0;
+        g_synthetic_config.rate_jitter = CLAMP(rate_jitter, 0.0, 1.0);
+        g_synthetic_config.min_token_chars = MAX(1, min_token_chars);
+        g_synthetic_config.max_token_chars = MAX(g_synthetic_config.min_token_chars, max_token_chars);
+        g_synthetic_config.mean_token_chars = CLAMP(mean_token_chars, (gdouble)g_synthetic_config.min_token_chars,
+                                                    (gdouble)g_synthetic_config.max_token_chars);
+    }
+    g_synthetic_enabled = enabled;
+    if (!enabled) {
+        g_synthetic_loaded = false;
+    }
+    g_debug("Synthetic backend %s: %.1f tokens/s, %d-%d chars (mean %.1f)", enabled ? "enabled" : "disabled",
+            tokens_per_second, min_token_chars, max_token_chars, mean_token_chars);
+}
+
+gint64 sambo_llama_get_synthetic_tokens_emitted() {
+    return g_synthetic_emitted;
+}
+
 // Fonctions de base
 gboolean sambo_llama_backend_init() {
 #ifdef HAVE_LLAMA_CPP
@@ -47,6 +457,10 @@ void sambo_llama_backend_free() {
         llama_free(g_context);
         g_context = nullptr;
     }
+    g_lora_cache.clear();
+    g_active_loras.clear();
+    sambo_drop_saved_state();
+    g_model_suspended = false;
     if (g_model) {
         llama_model_free(g_model);
         g_model = nullptr;
@@ -102,26 +516,34 @@ void sambo_llama_configure_performance(gint n_threads, gint batch_size, gboolean
 
 // Gestion des modèles
 gboolean sambo_llama_load_model(const gchar* model_path) {
+    if (g_synthetic_enabled) {
+        g_debug("Synthetic backend: model %s not read", model_path);
+        g_synthetic_loaded = true;
+        return TRUE;
+    }
 #ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
     if (!g_backend_initialized) {
         sambo_llama_backend_init();
     }
 
-    if (g_model) {
-        llama_model_free(g_model);
-        g_model = nullptr;
-    }
     if (g_context) {
         llama_free(g_context);
         g_context = nullptr;
     }
-
-    // Paramètres par défaut pour le modèle
-    llama_model_params model_params = llama_model_default_params();
-    model_params.n_gpu_layers = 0; // CPU seulement pour l'instant
+    g_lora_cache.clear();
+    g_active_loras.clear();
+    if (g_model) {
+        llama_model_free(g_model);
+        g_model = nullptr;
+    }
+    g_cached_tokens.clear();
+    sambo_drop_saved_state();
+    g_model_suspended = false;
+    g_resume_loras.clear();
 
     g_debug("Loading model: %s", model_path);
-    g_model = llama_model_load_from_file(model_path, model_params);
+    g_model = llama_model_load_from_file(model_path, sambo_model_params());
 
     if (!g_model) {
         g_warning("Failed to load model: %s", model_path);
@@ -129,13 +551,14 @@ gboolean sambo_llama_load_model(const gchar* model_path) {
     }
     g_debug("Model loaded successfully into g_model: %p", (void*)g_model);
 
-    // Créer le contexte
-    llama_context_params ctx_params = llama_context_default_params();
-    ctx_params.n_ctx = 2048; // Contexte par défaut
-    ctx_params.n_threads = sambo_llama_get_optimal_threads();
-    ctx_params.n_threads_batch = ctx_params.n_threads;
-
-    g_context = llama_init_from_model(g_model, ctx_params);
+    // Créer le contexte avec les réglages du profil
+    SamboContextConfig config;
+    {
+        std::lock_guard<std::mutex> config_lock(g_load_config_mutex);
+        config = g_load_context_config;
+    }
+    g_context = sambo_create_context_locked(config);
+    g_context_config = config;
 
     if (!g_context) {
         g_warning("Failed to create context for model: %s", model_path);
@@ -144,6 +567,7 @@ gboolean sambo_llama_load_model(const gchar* model_path) {
         return FALSE;
     }
     g_debug("Context created successfully: %p", (void*)g_context);
+    g_model_path = model_path;
 
     g_debug("Model loaded successfully: %s", model_path);
     return TRUE;
@@ -154,27 +578,153 @@ gboolean sambo_llama_load_model(const gchar* model_path) {
 }
 
 void sambo_llama_unload_model() {
+    g_synthetic_loaded = false;
 #ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
     if (g_context) {
         llama_free(g_context);
         g_context = nullptr;
     }
+    g_lora_cache.clear();
+    g_active_loras.clear();
     if (g_model) {
         llama_model_free(g_model);
         g_model = nullptr;
     }
+    g_cached_tokens.clear();
+    sambo_drop_saved_state();
+    g_model_suspended = false;
+    g_resume_loras.clear();
     g_debug("Model unloaded");
 #else
     g_debug("Simulation: Unloading model");
 #endif
 }
 
+// Adaptateurs LoRA
+gboolean sambo_llama_preload_lora_adapter(const gchar* path) {
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (!g_model) {
+        // Modèle suspendu : les adaptateurs seront chargés à la reprise
+        return g_model_suspended;
+    }
+    return sambo_get_lora_locked(path) != nullptr;
+#else
+    g_debug("Simulation: Preloading LoRA adapter: %s", path);
+    return TRUE;
+#endif
+}
+
+gboolean sambo_llama_set_lora_adapters(const gchar* const* paths, const gfloat* scales, gint count) {
+    if (g_synthetic_enabled) {
+        return count == 0;
+    }
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (!sambo_ensure_model_locked() || !sambo_ensure_context_locked(g_context_config)) {
+        return FALSE;
+    }
+
+    gboolean all_applied = TRUE;
+    std::vector<std::pair<llama_adapter_lora*, float>> wanted;
+    for (gint i = 0; i < count; i++) {
+        llama_adapter_lora* adapter = sambo_get_lora_locked(paths[i]);
+        if (!adapter) {
+            all_applied = FALSE;
+            continue;
+        }
+        wanted.emplace_back(adapter, scales ? scales[i] : 1.0f);
+    }
+
+    if (wanted == g_active_loras) {
+        return all_applied;
+    }
+
+    llama_clear_adapter_lora(g_context);
+    for (const auto& entry : wanted) {
+        if (llama_set_adapter_lora(g_context, entry.first, entry.second) != 0) {
+            g_warning("Failed to attach LoRA adapter (scale %.2f)", entry.second);
+            all_applied = FALSE;
+        }
+    }
+    g_active_loras = wanted;
+
+    // Le cache KV a été calculé avec d'autres adaptateurs : il n'est plus réutilisable
+    llama_memory_clear(llama_get_memory(g_context), true);
+    g_cached_tokens.clear();
+    g_debug("%zu LoRA adapter(s) attached", wanted.size());
+    return all_applied;
+#else
+    (void)paths;  // Supprimer warning unused parameter
+    (void)scales; // Supprimer warning unused parameter
+    g_debug("Simulation: Attaching %d LoRA adapter(s)", count);
+    return TRUE;
+#endif
+}
+
+// Réglages du contexte
+void sambo_llama_set_load_context_params(gint n_ctx, gint kv_cache_type, gboolean flash_attention) {
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_load_config_mutex);
+    g_load_context_config = sambo_make_context_config(n_ctx, kv_cache_type, flash_attention);
+#else
+    g_debug("Simulation: Context params n_ctx=%d, kv=%d, flash_attn=%d", n_ctx, kv_cache_type, flash_attention);
+#endif
+}
+
+gint64 sambo_llama_estimate_kv_cache_size(const gchar* model_path, gint n_ctx, gint kv_cache_type, gboolean flash_attention) {
+#ifdef HAVE_LLAMA_CPP
+    // Seules les métadonnées sont lues, pas les poids
+    gguf_init_params gguf_params = { /* no_alloc */ true, /* ctx */ nullptr };
+    gguf_context* gguf = gguf_init_from_file(model_path, gguf_params);
+    if (!gguf) {
+        return -1;
+    }
+
+    gint64 result = -1;
+    int64_t arch_id = gguf_find_key(gguf, "general.architecture");
+    if (arch_id >= 0 && gguf_get_kv_type(gguf, arch_id) == GGUF_TYPE_STRING) {
+        std::string arch = gguf_get_val_str(gguf, arch_id);
+        uint64_t n_layer = 0, n_embd = 0, n_head = 0;
+        if (sambo_gguf_get_uint(gguf, arch + ".block_count", &n_layer) &&
+            sambo_gguf_get_uint(gguf, arch + ".embedding_length", &n_embd) &&
+            sambo_gguf_get_uint(gguf, arch + ".attention.head_count", &n_head) && n_head > 0) {
+            uint64_t n_head_kv = n_head;
+            uint64_t key_length = n_embd / n_head;
+            uint64_t value_length = n_embd / n_head;
+            sambo_gguf_get_uint(gguf, arch + ".attention.head_count_kv", &n_head_kv);
+            sambo_gguf_get_uint(gguf, arch + ".attention.key_length", &key_length);
+            sambo_gguf_get_uint(gguf, arch + ".attention.value_length", &value_length);
+
+            SamboContextConfig config = sambo_make_context_config(n_ctx, kv_cache_type, flash_attention);
+            size_t k_row = ggml_row_size(sambo_kv_ggml_type(config.kv_cache_type), key_length * n_head_kv);
+            size_t v_row = ggml_row_size(sambo_kv_value_type(config), value_length * n_head_kv);
+            result = (gint64)config.n_ctx * (gint64)n_layer * (gint64)(k_row + v_row);
+        }
+    }
+
+    gguf_free(gguf);
+    return result;
+#else
+    (void)model_path;      // Supprimer warning unused parameter
+    (void)n_ctx;           // Supprimer warning unused parameter
+    (void)kv_cache_type;   // Supprimer warning unused parameter
+    (void)flash_attention; // Supprimer warning unused parameter
+    return -1;
+#endif
+}
+
 gboolean sambo_llama_is_model_loaded() {
+    if (g_synthetic_enabled) {
+        return g_synthetic_loaded;
+    }
 #ifdef HAVE_LLAMA_CPP
-    // Retourner le vrai état : modèle ET contexte doivent être chargés
-    bool real_state = (g_model != nullptr && g_context != nullptr);
+    // Un modèle suspendu reste chargé du point de vue de l'appelant :
+    // il est rechargé à la prochaine génération
+    bool real_state = (g_model != nullptr || g_model_suspended);
     g_debug("Real model state check: model=%s, context=%s, result=%s",
-            g_model ? "loaded" : "null",
+            g_model ? "loaded" : (g_model_suspended ? "suspended" : "null"),
             g_context ? "loaded" : "null",
             real_state ? "true" : "false");
     return real_state;
@@ -184,6 +734,75 @@ gboolean sambo_llama_is_model_loaded() {
 #endif
 }
 
+// Résidence en mémoire
+gboolean sambo_llama_is_model_resident() {
+    if (g_synthetic_enabled) {
+        return g_synthetic_loaded;
+    }
+#ifdef HAVE_LLAMA_CPP
+    return g_model != nullptr;
+#else
+    return FALSE;
+#endif
+}
+
+gboolean sambo_llama_has_kv_cache() {
+#ifdef HAVE_LLAMA_CPP
+    return g_context != nullptr;
+#else
+    return FALSE;
+#endif
+}
+
+gboolean sambo_llama_release_kv_cache(const gchar* state_path) {
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (!g_context) {
+        return FALSE;
+    }
+    sambo_release_context_locked(state_path);
+    g_debug("KV cache released");
+    return TRUE;
+#else
+    (void)state_path; // Supprimer warning unused parameter
+    g_debug("Simulation: Releasing KV cache");
+    return FALSE;
+#endif
+}
+
+gboolean sambo_llama_suspend_model(const gchar* state_path) {
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (!g_model) {
+        return FALSE;
+    }
+
+    sambo_release_context_locked(state_path);
+
+    // Mémoriser les adaptateurs attachés pour les rattacher à la reprise
+    g_resume_loras.clear();
+    for (const auto& entry : g_active_loras) {
+        for (const auto& cached : g_lora_cache) {
+            if (cached.second == entry.first) {
+                g_resume_loras.emplace_back(cached.first, entry.second);
+            }
+        }
+    }
+    g_lora_cache.clear();
+    g_active_loras.clear();
+
+    llama_model_free(g_model);
+    g_model = nullptr;
+    g_model_suspended = true;
+    g_debug("Model suspended: %s", g_model_path.c_str());
+    return TRUE;
+#else
+    (void)state_path; // Supprimer warning unused parameter
+    g_debug("Simulation: Suspending model");
+    return FALSE;
+#endif
+}
+
 void sambo_llama_cleanup() {
 #ifdef HAVE_LLAMA_CPP
     sambo_llama_unload_model();
@@ -201,8 +820,24 @@ gboolean sambo_llama_generate(
     sambo_vala_stream_callback callback,
     gpointer user_data
 ) {
+    if (g_synthetic_enabled) {
+        if (!g_synthetic_loaded) {
+            return FALSE;
+        }
+        sambo_synthetic_run(params, [&](const std::string& token) {
+            if (callback) {
+                callback(token.c_str(), user_data, nullptr);
+            }
+            return true;
+        });
+        if (callback) {
+            callback("", user_data, nullptr);  // Signal de fin
+        }
+        return TRUE;
+    }
 #ifdef HAVE_LLAMA_CPP
-    if (!g_model || !g_context) {
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (!sambo_ensure_model_locked()) {
         g_warning("Model not loaded - cannot perform real inference");
         // Fallback vers simulation
         if (callback) {
@@ -213,6 +848,18 @@ gboolean sambo_llama_generate(
         return FALSE;
     }
 
+    // Taille et précision du cache KV propres au profil de la requête ;
+    // le contexte est recréé s'il a été libéré sous pression mémoire
+    SamboContextConfig wanted = params
+        ? sambo_make_context_config(params->context_length, params->kv_cache_type, params->flash_attention)
+        : g_context_config;
+    if (!sambo_ensure_context_locked(wanted)) {
+        g_warning("Requested context settings unavailable, using n_ctx=%d", g_context_config.n_ctx);
+        if (!g_context) {
+            return FALSE;
+        }
+    }
+
     g_debug("Performing real inference with llama.cpp for prompt: %s", prompt);
 
     try {
@@ -238,28 +885,47 @@ gboolean sambo_llama_generate(
 
         g_debug("Tokenized prompt: %d tokens", actual_tokens);
 
-        // Créer et remplir le batch
-        llama_batch batch = llama_batch_init(tokens.size(), 0, 1);
-        for (size_t i = 0; i < tokens.size(); i++) {
-            batch.token[batch.n_tokens] = tokens[i];
-            batch.pos[batch.n_tokens] = i;
-            batch.n_seq_id[batch.n_tokens] = 1;
-            batch.seq_id[batch.n_tokens][0] = 0;
-            batch.logits[batch.n_tokens] = false;
-            batch.n_tokens++;
+        if (actual_tokens >= (int)llama_n_ctx(g_context)) {
+            g_warning("Prompt too long for context: %d tokens (n_ctx=%u)", actual_tokens, llama_n_ctx(g_context));
+            return FALSE;
         }
 
-        // Marquer le dernier token pour la génération
-        if (batch.n_tokens > 0) {
-            batch.logits[batch.n_tokens - 1] = true;
+        // Réutiliser le préfixe déjà présent dans le cache KV (prompt système du
+        // profil, historique de conversation) : seule la suite est décodée.
+        // Le dernier token est toujours redécodé pour obtenir ses logits.
+        llama_memory_t memory = llama_get_memory(g_context);
+        size_t n_reused = 0;
+        while (n_reused < g_cached_tokens.size() && n_reused + 1 < tokens.size() &&
+               g_cached_tokens[n_reused] == tokens[n_reused]) {
+            n_reused++;
+        }
+        if (n_reused == 0 || !llama_memory_seq_rm(memory, 0, (llama_pos)n_reused, -1)) {
+            llama_memory_clear(memory, true);
+            n_reused = 0;
         }
+        g_cached_tokens.assign(tokens.begin(), tokens.begin() + n_reused);
 
-        // Traiter le prompt
-        if (llama_decode(g_context, batch) != 0) {
-            g_warning("Failed to decode prompt");
-            llama_batch_free(batch);
-            return FALSE;
+        g_debug("Prompt prefix reused from KV cache: %d/%d tokens", (int)n_reused, (int)tokens.size());
+
+        // Décoder la partie non réutilisée par tranches de n_batch tokens ; seul
+        // le dernier token du prompt demande des logits, lus dans la dernière tranche
+        const size_t n_batch = llama_n_batch(g_context);
+        llama_batch batch = llama_batch_init((int)n_batch, 0, 1);
+        for (size_t first = n_reused; first < tokens.size(); first += n_batch) {
+            size_t last = std::min(tokens.size(), first + n_batch);
+            batch.n_tokens = 0;
+            for (size_t i = first; i < last; i++) {
+                sambo_batch_add(batch, tokens[i], (llama_pos)i, 0, i + 1 == tokens.size());
+            }
+            if (llama_decode(g_context, batch) != 0) {
+                g_warning("Failed to decode prompt");
+                llama_batch_free(batch);
+                llama_memory_clear(memory, true);
+                g_cached_tokens.clear();
+                return FALSE;
+            }
         }
+        g_cached_tokens.insert(g_cached_tokens.end(), tokens.begin() + n_reused, tokens.end());
 
         g_debug("Prompt processed, starting generation...");
 
@@ -273,11 +939,7 @@ gboolean sambo_llama_generate(
                 max_tokens, temperature, top_p, top_k);
 
         // Créer un sampler avec les nouveaux paramètres
-        llama_sampler* sampler = llama_sampler_chain_init({});
-        llama_sampler_chain_add(sampler, llama_sampler_init_top_k(top_k));
-        llama_sampler_chain_add(sampler, llama_sampler_init_top_p(top_p, 1));
-        llama_sampler_chain_add(sampler, llama_sampler_init_temp(temperature));
-        llama_sampler_chain_add(sampler, llama_sampler_init_dist(1337));
+        llama_sampler* sampler = sambo_create_sampler(params, 1337);
 
         // Générer des tokens
         int n_generated = 0;
@@ -336,6 +998,7 @@ gboolean sambo_llama_generate(
                 g_warning("Failed to decode generated token");
                 break;
             }
+            g_cached_tokens.push_back(new_token);
 
             n_generated++;
         }
@@ -397,10 +1060,17 @@ gchar* sambo_llama_generate_simple(
     const gchar* prompt,
     SamboSamplingParams* params
 ) {
-    (void)params; // Supprimer warning unused parameter
+    if (g_synthetic_enabled) {
+        std::string response;
+        sambo_synthetic_run(params, [&](const std::string& token) {
+            response += token;
+            return true;
+        });
+        return g_strdup(response.c_str());
+    }
 
 #ifdef HAVE_LLAMA_CPP
-    if (!g_model || !g_context) {
+    if (!sambo_llama_is_model_loaded()) {
         g_warning("Model not loaded for simple generation");
         return g_strdup("Erreur: modèle non chargé");
     }
@@ -445,7 +1115,199 @@ gchar* sambo_llama_generate_simple(
 #endif
 }
 
+gint sambo_llama_count_tokens(const gchar* text) {
+    if (g_synthetic_enabled) {
+        return g_synthetic_loaded ? (gint)(strlen(text) / 4 + 1) : -1;
+    }
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (!sambo_ensure_model_locked()) {
+        return -1;
+    }
+    const llama_vocab* vocab = llama_model_get_vocab(g_model);
+    return -llama_tokenize(vocab, text, strlen(text), nullptr, 0, false, true);
+#else
+    return -1;
+#endif
+}
+
+gboolean sambo_llama_generate_parallel(
+    const gchar* const* prompts,
+    gint n_prompts,
+    SamboSamplingParams* params,
+    sambo_parallel_callback callback,
+    gpointer user_data
+) {
+    if (g_synthetic_enabled) {
+        if (!g_synthetic_loaded || n_prompts <= 0) {
+            return FALSE;
+        }
+        // Les séquences reçoivent leurs tokens à tour de rôle, comme un batch décodé pas à pas
+        gint sequence = 0;
+        SamboSamplingParams steps = params ? *params : SamboSamplingParams{};
+        steps.max_tokens = (params ? params->max_tokens : 512) * n_prompts;
+        sambo_synthetic_run(&steps, [&](const std::string& token) {
+            gboolean keep_going = callback ? callback(sequence, token.c_str(), user_data) : TRUE;
+            sequence = (sequence + 1) % n_prompts;
+            return keep_going != FALSE;
+        });
+        return TRUE;
+    }
+#ifdef HAVE_LLAMA_CPP
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (n_prompts <= 0 || !sambo_ensure_model_locked()) {
+        return FALSE;
+    }
+
+    // Une séquence du cache KV par prompt
+    SamboContextConfig wanted = params
+        ? sambo_make_context_config(params->context_length, params->kv_cache_type, params->flash_attention)
+        : g_context_config;
+    wanted.n_seq_max = n_prompts;
+    if (!sambo_ensure_context_locked(wanted) || g_context_config.n_seq_max < n_prompts) {
+        g_warning("Cannot create a context for %d parallel sequences", n_prompts);
+        return FALSE;
+    }
+
+    const llama_vocab* vocab = llama_model_get_vocab(g_model);
+    const int max_tokens = params ? params->max_tokens : 512;
+    const int n_ctx = (int)llama_n_ctx(g_context);
+    const int n_batch = (int)llama_n_batch(g_context);
+
+    std::vector<std::vector<llama_token>> sequences(n_prompts);
+    size_t n_required = 0;
+    for (gint s = 0; s < n_prompts; s++) {
+        const int n_tokens = -llama_tokenize(vocab, prompts[s], strlen(prompts[s]), nullptr, 0, true, true);
+        if (n_tokens <= 0) {
+            g_warning("Failed to tokenize parallel prompt %d", s);
+            return FALSE;
+        }
+        sequences[s].resize(n_tokens);
+        llama_tokenize(vocab, prompts[s], strlen(prompts[s]), sequences[s].data(), n_tokens, true, true);
+        n_required += n_tokens + max_tokens;
+    }
+    if (n_required > (size_t)n_ctx) {
+        g_warning("Parallel prompts exceed context: %zu > %d tokens", n_required, n_ctx);
+        return FALSE;
+    }
+
+    // Le cache KV est entièrement utilisé par les séquences parallèles
+    llama_memory_t memory = llama_get_memory(g_context);
+    llama_memory_clear(memory, true);
+    g_cached_tokens.clear();
+
+    struct SequenceState {
+        llama_sampler* sampler = nullptr;
+        llama_token next = 0;
+        llama_pos n_past = 0;
+        int n_generated = 0;
+        int logits_index = -1;
+        bool active = false;
+    };
+    std::vector<SequenceState> states(n_prompts);
+    llama_batch batch = llama_batch_init(std::max(n_batch, (int)n_prompts), 0, 1);
+    g_generation_stopped = false;
+    gboolean success = TRUE;
+    gint64 start = g_get_monotonic_time();
+
+    // Prompts : décodés séquence par séquence, par tranches de n_batch tokens
+    for (gint s = 0; s < n_prompts && success; s++) {
+        const auto& tokens = sequences[s];
+        // Graine du profil si elle est fixée, décalée par séquence
+        const uint32_t seed = params && params->seed >= 0 ? (uint32_t)params->seed : 1337;
+        states[s].sampler = sambo_create_sampler(params, seed + (uint32_t)s);
+        for (size_t first = 0; first < tokens.size(); first += n_batch) {
+            size_t last = std::min(tokens.size(), first + (size_t)n_batch);
+            batch.n_tokens = 0;
+            for (size_t i = first; i < last; i++) {
+                sambo_batch_add(batch, tokens[i], (llama_pos)i, s, i + 1 == tokens.size());
+            }
+            if (llama_decode(g_context, batch) != 0) {
+                g_warning("Failed to decode parallel prompt %d", s);
+                success = FALSE;
+                break;
+            }
+        }
+        if (success) {
+            states[s].n_past = (llama_pos)tokens.size();
+            states[s].next = llama_sampler_sample(states[s].sampler, g_context, batch.n_tokens - 1);
+            states[s].active = true;
+        }
+    }
+    gint64 prompt_done = g_get_monotonic_time();
+
+    // Génération : un token par séquence active et par décodage
+    int n_generated_total = 0;
+    bool stopped = !success;
+    while (!stopped && !g_generation_stopped) {
+        batch.n_tokens = 0;
+        for (gint s = 0; s < n_prompts && !stopped; s++) {
+            SequenceState& state = states[s];
+            state.logits_index = -1;
+            if (!state.active) {
+                continue;
+            }
+            if (llama_vocab_is_eog(vocab, state.next) || state.n_generated >= max_tokens) {
+                state.active = false;
+                continue;
+            }
+
+            char piece[256];
+            const int n_chars = llama_token_to_piece(vocab, state.next, piece, sizeof(piece) - 1, 0, false);
+            if (n_chars > 0) {
+                piece[n_chars] = '\0';
+                if (callback && !callback(s, piece, user_data)) {
+                    stopped = true;
+                    break;
+                }
+            }
+
+            state.logits_index = batch.n_tokens;
+            sambo_batch_add(batch, state.next, state.n_past, s, true);
+            state.n_past++;
+            state.n_generated++;
+            n_generated_total++;
+        }
+
+        if (stopped || batch.n_tokens == 0) {
+            break;
+        }
+        if (llama_decode(g_context, batch) != 0) {
+            g_warning("Failed to decode parallel batch");
+            success = FALSE;
+            break;
+        }
+        for (gint s = 0; s < n_prompts; s++) {
+            if (states[s].logits_index >= 0) {
+                states[s].next = llama_sampler_sample(states[s].sampler, g_context, states[s].logits_index);
+            }
+        }
+    }
+
+    for (auto& state : states) {
+        if (state.sampler) {
+            llama_sampler_free(state.sampler);
+        }
+    }
+    llama_batch_free(batch);
+    llama_memory_clear(memory, true);
+
+    gint64 end = g_get_monotonic_time();
+    g_debug("Parallel generation: %d sequences, prompts in %.1f ms, %d tokens in %.1f ms",
+            n_prompts, (prompt_done - start) / 1000.0, n_generated_total, (end - prompt_done) / 1000.0);
+    return success;
+#else
+    (void)prompts;   // Supprimer warning unused parameter
+    (void)params;    // Supprimer warning unused parameter
+    (void)callback;  // Supprimer warning unused parameter
+    (void)user_data; // Supprimer warning unused parameter
+    g_debug("Simulation: Parallel generation of %d prompts", n_prompts);
+    return FALSE;
+#endif
+}
+
 void sambo_llama_stop_generation() {
+    g_synthetic_stopped = true;
 #ifdef HAVE_LLAMA_CPP
     g_debug("Stopping llama.cpp generation");
     g_generation_stopped = true;
@@ -22,8 +22,31 @@ gboolean sambo_llama_load_model(const gchar* model_path);
 void sambo_llama_unload_model();
 gboolean sambo_llama_is_model_loaded();
 
+// Résidence en mémoire : le cache KV puis le modèle peuvent être libérés,
+// l'état de session étant sauvegardé et restauré à la prochaine génération
+gboolean sambo_llama_is_model_resident();
+gboolean sambo_llama_has_kv_cache();
+gboolean sambo_llama_release_kv_cache(const gchar* state_path);
+gboolean sambo_llama_suspend_model(const gchar* state_path);
+
+// Adaptateurs LoRA (chargés une fois, attachés au contexte sans recharger le modèle)
+gboolean sambo_llama_preload_lora_adapter(const gchar* path);
+gboolean sambo_llama_set_lora_adapters(const gchar* const* paths, const gfloat* scales, gint count);
+
 void sambo_llama_cleanup();
 
+// Précision du cache KV
+typedef enum {
+    SAMBO_KV_CACHE_F16 = 0,
+    SAMBO_KV_CACHE_Q8_0 = 1,
+    SAMBO_KV_CACHE_Q4_0 = 2
+} SamboKvCacheType;
+
+// Réglages du contexte appliqués au prochain chargement de modèle
+void sambo_llama_set_load_context_params(gint n_ctx, gint kv_cache_type, gboolean flash_attention);
+// Taille estimée du cache KV en octets, lue dans les métadonnées GGUF (-1 si inconnue)
+gint64 sambo_llama_estimate_kv_cache_size(const gchar* model_path, gint n_ctx, gint kv_cache_type, gboolean flash_attention);
+
 // Structure pour les paramètres de sampling
 typedef struct {
     gfloat temperature;
@@ -36,6 +59,8 @@ typedef struct {
     gint seed;
     gint context_length;
     gboolean stream;
+    gint kv_cache_type;
+    gboolean flash_attention;
 } SamboSamplingParams;
 
 // Callback pour le streaming
@@ -57,8 +82,30 @@ gchar* sambo_llama_generate_simple(
     SamboSamplingParams* params
 );
 
+// Génération de plusieurs prompts en séquences parallèles dans un même batch ;
+// le callback reçoit l'indice du prompt et retourne FALSE pour tout arrêter
+typedef gboolean (*sambo_parallel_callback)(gint sequence, const gchar* token, gpointer user_data);
+
+gboolean sambo_llama_generate_parallel(
+    const gchar* const* prompts,
+    gint n_prompts,
+    SamboSamplingParams* params,
+    sambo_parallel_callback callback,
+    gpointer user_data
+);
+
+// Nombre de tokens d'un texte pour le modèle chargé (-1 si indisponible)
+gint sambo_llama_count_tokens(const gchar* text);
+
 void sambo_llama_stop_generation();
 
+// Source de tokens synthétique (bancs d'essai) : une fois activée, le
+// chargement ne lit aucun fichier et la génération émet du texte aléatoire
+// au débit et selon la distribution de tailles demandés
+void sambo_llama_set_synthetic_backend(gboolean enabled, gdouble tokens_per_second, gdouble rate_jitter,
+                                       gint min_token_chars, gdouble mean_token_chars, gint max_token_chars);
+gint64 sambo_llama_get_synthetic_tokens_emitted();
+
 G_END_DECLS
 
 #endif // SAMBO_LLAMA_WRAPPER_H
@@ -238,6 +238,11 @@ namespace Sambo {
             clear_format_button.set_tooltip_text(_("Effacer le formatage"));
             clear_format_button.add_css_class("flat");
 
+            // 17. Envoi du document au chat (traitement des documents longs)
+            var send_to_chat_button = new Button.from_icon_name("mail-send-symbolic");
+            send_to_chat_button.set_tooltip_text(_("Envoyer au chat (document long)"));
+            send_to_chat_button.add_css_class("flat");
+
             special_group.append(code_button);
             special_group.append(inline_code_button);
             special_group.append(table_button);
@@ -247,6 +252,7 @@ namespace Sambo {
             special_group.append(separator4);
             special_group.append(formula_button);
             special_group.append(clear_format_button);
+            special_group.append(send_to_chat_button);
 
             // Ajouter directement le groupe à la toolbar
             toolbar_box.append(special_group);
@@ -293,6 +299,12 @@ namespace Sambo {
                 wysiwyg_editor.apply_code();
             });
 
+            send_to_chat_button.clicked.connect(() => {
+                string title = (current_file_path != null && current_file_path != "") ?
+                    Path.get_basename(current_file_path) : _("Nouveau document");
+                controller.send_document_to_chat(wysiwyg_editor.get_pivot_document(), title);
+            });
+
             bullet_list_button.clicked.connect(() => {
                 wysiwyg_editor.insert_list(false);
             });
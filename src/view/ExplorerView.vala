@@ -640,6 +640,8 @@ namespace Sambo {
         private CustomFilter hidden_filter;
         private FilterListModel filter_model;
         private Set<string> extension_filter = new HashSet<string>();
+        // Dernière ligne cliquée : élément courant tant qu'elle reste sélectionnée
+        private FileItemModel? clicked_item = null;
 
         // Widget du fil d'Ariane
         private BreadcrumbWidget breadcrumb_widget;
@@ -773,8 +775,8 @@ namespace Sambo {
             factory.setup.connect(on_setup_listitem);
             factory.bind.connect(on_bind_listitem);
 
-            // Sélection
-            var selection = new SingleSelection(filter_model);
+            // Sélection multiple (traitements par lot)
+            var selection = new MultiSelection(filter_model);
 
             // S'assurer que la sélection est bien mise à jour lorsqu'un élément est sélectionné
             selection.selection_changed.connect((position, n_items) => {
@@ -795,25 +797,13 @@ namespace Sambo {
             right_click_controller.pressed.connect(on_right_click);
             list_view.add_controller(right_click_controller);
 
-            // Ajouter un contrôleur pour le clic gauche standard
+            // Noter la ligne cliquée avant que la ListView ne mette à jour la sélection
+            // (le double-clic est traité par le signal activate)
             var left_click_controller = new GestureClick();
             left_click_controller.set_button(1);  // Bouton gauche
-            left_click_controller.released.connect((n_press, x, y) => {
-                if (n_press == 1) {
-                    // Clic simple - La sélection est déjà gérée par SingleSelection
-                    // Vous pouvez ajouter d'autres comportements ici si nécessaire
-                } else if (n_press == 2) {
-                    // Double-clic - Simuler un signal d'activation
-                    // Obtenir l'élément sur lequel on a cliqué
-                    var selection_model = list_view.get_model() as SingleSelection;
-                    if (selection_model != null) {
-                        var file_item = selection_model.get_selected_item() as FileItemModel;
-                        if (file_item != null) {
-                            // Appeler directement on_item_activated
-                            on_item_activated(selection_model.get_selected());
-                        }
-                    }
-                }
+            left_click_controller.set_propagation_phase(PropagationPhase.CAPTURE);
+            left_click_controller.pressed.connect((n_press, x, y) => {
+                clicked_item = get_item_at(x, y);
             });
             list_view.add_controller(left_click_controller);
 
@@ -856,6 +846,7 @@ namespace Sambo {
 
             box.append(icon);
             box.append(name_label);
+            box.set_data("type", "row");
 
             list_item.set_child(box);
         }
@@ -870,6 +861,9 @@ namespace Sambo {
 
             if (file_item == null || box == null) return;
 
+            // Retrouver l'élément d'une ligne à partir du widget sous le pointeur
+            box.set_data<FileItemModel>("file-item", file_item);
+
             // Trouver les widgets par leur donnée associée en utilisant get_first_child et get_next_sibling
             Gtk.Image? icon = null;
             Label? name_label = null;
@@ -916,10 +910,7 @@ namespace Sambo {
 
             // Configurer la fonction qui fournit les données à glisser
             drag_source.prepare.connect((source, x, y) => {
-                var selection = list_view.get_model() as SingleSelection;
-                if (selection == null) return null;
-
-                var file_item = selection.get_selected_item() as FileItemModel;
+                var file_item = select_item_at(x, y);
                 if (file_item == null) return null;
 
                 // Créer une valeur contenant le chemin du fichier
@@ -1042,12 +1033,7 @@ namespace Sambo {
          */
         private void on_item_activated(uint position) {
 
-            var selection = list_view.get_model() as SingleSelection;
-            if (selection == null) {
-                return;
-            }
-
-            var file_item = selection.get_selected_item() as FileItemModel;
+            var file_item = list_view.get_model().get_item(position) as FileItemModel;
             if (file_item == null) {
                 return;
             }
@@ -1101,11 +1087,8 @@ namespace Sambo {
          * Gère le clic droit pour afficher un menu contextuel
          */
         private void on_right_click(int n_press, double x, double y) {
-            // Vérifier si un élément est sélectionné
-            var selection = list_view.get_model() as SingleSelection;
-            if (selection == null) return;
-
-            var file_item = selection.get_selected_item() as FileItemModel;
+            // Le menu porte sur la ligne cliquée, sélectionnée si elle ne l'était pas
+            var file_item = select_item_at(x, y);
             if (file_item == null) return;
 
             // Créer le menu
@@ -1162,6 +1145,12 @@ namespace Sambo {
             modify_section.append(_("Renommer"), "win.rename-file");
             modify_section.append(_("Supprimer"), "win.delete-file");
 
+            // Traitement par lot des fichiers sélectionnés
+            var batch_section = new GLib.Menu();
+            if (get_selected_files().size > 0) {
+                batch_section.append(_("Traitement par lot..."), "win.batch-process");
+            }
+
             // Éléments pour les propriétés
             var properties_section = new GLib.Menu();
             properties_section.append(_("Propriétés"), "win.file-properties");
@@ -1170,6 +1159,7 @@ namespace Sambo {
             menu.append_section(null, common_section);
             menu.append_section(null, edit_section);
             menu.append_section(null, modify_section);
+            menu.append_section(null, batch_section);
             menu.append_section(null, properties_section);
 
             // Connecter les actions
@@ -1247,9 +1237,26 @@ namespace Sambo {
                 }
             });
 
+            // Action pour lancer un traitement par lot sur la sélection
+            var batch_process_action = new SimpleAction("batch-process", null);
+            batch_process_action.activate.connect(() => {
+                var dialog = new BatchJobDialog(controller, get_selected_files());
+                dialog.set_transient_for(window);
+                dialog.job_submitted.connect((job) => {
+                    var toast = new Adw.Toast("Traitement par lot lancé : %d fichier(s)".printf(job.get_total()));
+                    toast.set_timeout(3);
+                    var toast_overlay = get_ancestor(typeof(Adw.ToastOverlay)) as Adw.ToastOverlay;
+                    if (toast_overlay != null) {
+                        toast_overlay.add_toast(toast);
+                    }
+                });
+                dialog.present();
+            });
+
             // Utiliser ActionMap pour ajouter les actions à la fenêtre
             ActionMap action_map = window as ActionMap;
             if (action_map != null) {
+                action_map.add_action(batch_process_action);
                 action_map.add_action(open_folder_action);
                 action_map.add_action(open_folder_new_tab_action);
                 action_map.add_action(open_file_action);
@@ -1259,16 +1266,100 @@ namespace Sambo {
             }
         }
 
+        /**
+         * Élément courant (prévisualisation, menu contextuel) : la dernière
+         * ligne cliquée si elle est toujours sélectionnée, sinon la première
+         * ligne sélectionnée
+         */
+        private FileItemModel? get_selected_file_item() {
+            var selection = list_view.get_model() as MultiSelection;
+            if (selection == null) return null;
+
+            if (clicked_item != null) {
+                uint position = find_position(clicked_item);
+                if (position != INVALID_LIST_POSITION && selection.is_selected(position)) {
+                    return clicked_item;
+                }
+            }
+
+            var selected = selection.get_selection();
+            if (selected.is_empty()) return null;
+            return selection.get_item(selected.get_minimum()) as FileItemModel;
+        }
+
+        /**
+         * Élément de la ligne sous le pointeur, coordonnées relatives à list_view
+         */
+        private FileItemModel? get_item_at(double x, double y) {
+            var widget = list_view.pick(x, y, PickFlags.DEFAULT);
+            while (widget != null && widget != list_view) {
+                if (widget.get_data<string>("type") == "row") {
+                    return widget.get_data<FileItemModel>("file-item");
+                }
+                widget = widget.get_parent();
+            }
+            return null;
+        }
+
+        private uint find_position(FileItemModel file_item) {
+            var items = list_view.get_model();
+            for (uint i = 0; i < items.get_n_items(); i++) {
+                if (items.get_item(i) == file_item) {
+                    return i;
+                }
+            }
+            return INVALID_LIST_POSITION;
+        }
+
+        /**
+         * Fait de la ligne sous le pointeur l'élément courant
+         *
+         * Une ligne déjà sélectionnée garde la sélection multiple (traitement
+         * par lot) ; sinon elle devient la seule ligne sélectionnée.
+         */
+        private FileItemModel? select_item_at(double x, double y) {
+            var selection = list_view.get_model() as MultiSelection;
+            var file_item = get_item_at(x, y);
+            if (selection == null || file_item == null) return null;
+
+            uint position = find_position(file_item);
+            if (position == INVALID_LIST_POSITION) return null;
+
+            clicked_item = file_item;
+            if (!selection.is_selected(position)) {
+                selection.select_item(position, true);
+            }
+            return file_item;
+        }
+
+        /**
+         * Chemins des fichiers (hors dossiers) sélectionnés
+         */
+        private Gee.List<string> get_selected_files() {
+            var paths = new Gee.ArrayList<string>();
+            var selection = list_view.get_model() as MultiSelection;
+            if (selection == null) return paths;
+
+            var selected = selection.get_selection();
+            BitsetIter iter;
+            uint position;
+            if (!BitsetIter.init_first(out iter, selected, out position)) return paths;
+            do {
+                var file_item = selection.get_item(position) as FileItemModel;
+                if (file_item != null && !file_item.is_directory()) {
+                    paths.add(file_item.path);
+                }
+            } while (iter.next(out position));
+            return paths;
+        }
+
         /**
          * Gère la sélection d'un élément pour la prévisualisation
          */
         private void on_selection_changed(uint position, uint n_items) {
             if (!show_preview || preview_widget == null) return;
 
-            var selection = list_view.get_model() as SingleSelection;
-            if (selection == null) return;
-
-            var file_item = selection.get_selected_item() as FileItemModel;
+            var file_item = get_selected_file_item();
 
             if (file_item != null) {
                 // Essayer d'appeler preview_file si elle existe
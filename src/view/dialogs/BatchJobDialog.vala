@@ -0,0 +1,134 @@
+using Gtk;
+using Adw;
+
+namespace Sambo {
+    /**
+     * Boîte de dialogue de lancement d'un traitement par lot sur des fichiers
+     */
+    public class BatchJobDialog : Adw.Window {
+        private ApplicationController controller;
+        private Gee.List<string> paths;
+        private Gee.ArrayList<InferenceProfile> profiles = new Gee.ArrayList<InferenceProfile>();
+
+        private DropDown profile_dropdown;
+        private TextView instruction_view;
+        private Entry suffix_entry;
+
+        /**
+         * Émis quand le traitement a été placé dans la file
+         */
+        public signal void job_submitted(BatchJob job);
+
+        public BatchJobDialog(ApplicationController controller, Gee.List<string> paths) {
+            Object(
+                title: "Traitement par lot",
+                default_width: 520,
+                default_height: 420,
+                modal: true
+            );
+
+            this.controller = controller;
+            this.paths = paths;
+            create_ui();
+        }
+
+        private void create_ui() {
+            var main_box = new Box(Orientation.VERTICAL, 0);
+
+            var header_bar = new Adw.HeaderBar();
+            header_bar.set_title_widget(new Adw.WindowTitle("Traitement par lot",
+                "%d fichier(s) sélectionné(s)".printf(paths.size)));
+            header_bar.set_show_end_title_buttons(false);
+
+            var cancel_button = new Button.with_label("Annuler");
+            cancel_button.clicked.connect(() => close());
+            header_bar.pack_start(cancel_button);
+
+            var start_button = new Button.with_label("Lancer");
+            start_button.add_css_class("suggested-action");
+            start_button.clicked.connect(on_start_clicked);
+            header_bar.pack_end(start_button);
+
+            main_box.append(header_bar);
+
+            var content = new Box(Orientation.VERTICAL, 12);
+            content.set_margin_start(18);
+            content.set_margin_end(18);
+            content.set_margin_top(18);
+            content.set_margin_bottom(18);
+
+            // Profil d'inférence
+            var profile_names = new StringList(null);
+            var config = controller.get_config_manager();
+            var selected = config.get_selected_profile_id();
+            uint selected_index = 0;
+            foreach (var profile in config.get_all_profiles()) {
+                if (profile.id == selected) {
+                    selected_index = profiles.size;
+                }
+                profiles.add(profile);
+                profile_names.append(profile.title);
+            }
+            profile_dropdown = new DropDown(profile_names, null);
+            profile_dropdown.set_selected(selected_index);
+
+            var profile_row = new Box(Orientation.HORIZONTAL, 12);
+            var profile_label = new Label("Profil");
+            profile_label.set_hexpand(true);
+            profile_label.set_halign(Align.START);
+            profile_row.append(profile_label);
+            profile_row.append(profile_dropdown);
+            content.append(profile_row);
+
+            // Consigne appliquée à chaque fichier
+            var instruction_label = new Label("Consigne appliquée à chaque fichier");
+            instruction_label.set_halign(Align.START);
+            content.append(instruction_label);
+
+            instruction_view = new TextView();
+            instruction_view.set_wrap_mode(WrapMode.WORD_CHAR);
+            instruction_view.get_buffer().set_text("Résume ce document en quelques paragraphes.");
+            var instruction_scroll = new ScrolledWindow();
+            instruction_scroll.set_policy(PolicyType.NEVER, PolicyType.AUTOMATIC);
+            instruction_scroll.set_vexpand(true);
+            instruction_scroll.set_child(instruction_view);
+            instruction_scroll.add_css_class("card");
+            content.append(instruction_scroll);
+
+            // Suffixe des fichiers de sortie
+            var suffix_row = new Box(Orientation.HORIZONTAL, 12);
+            var suffix_label = new Label("Suffixe des fichiers produits");
+            suffix_label.set_hexpand(true);
+            suffix_label.set_halign(Align.START);
+            suffix_entry = new Entry();
+            suffix_entry.set_text(".resume.md");
+            suffix_row.append(suffix_label);
+            suffix_row.append(suffix_entry);
+            content.append(suffix_row);
+
+            main_box.append(content);
+            set_content(main_box);
+
+            start_button.set_sensitive(profiles.size > 0 && paths.size > 0);
+        }
+
+        private void on_start_clicked() {
+            uint index = profile_dropdown.get_selected();
+            if (index == Gtk.INVALID_LIST_POSITION || index >= profiles.size) {
+                return;
+            }
+
+            TextIter start, end;
+            instruction_view.get_buffer().get_bounds(out start, out end);
+            string instruction = instruction_view.get_buffer().get_text(start, end, false).strip();
+            string suffix = suffix_entry.get_text().strip();
+            if (instruction == "" || suffix == "") {
+                return;
+            }
+
+            var job = controller.get_batch_job_manager().submit(profiles[(int) index], instruction, paths, suffix);
+            job_submitted(job);
+            close();
+        }
+    }
+}
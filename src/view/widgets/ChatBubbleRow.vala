@@ -6,65 +6,46 @@ namespace Sambo {
      * Widget représentant une bulle de message dans l'interface de chat
      */
     public class ChatBubbleRow : Gtk.Box {
+        private Box bubble_box;
         private TextView content_text_view;
         private Label time_label;
-        private ChatMessage message;
+        private ChatMessage? message = null;
 
         // Optimisations UI
         private uint update_timeout_id = 0;     // ID du timeout pour debouncing
         private int64 last_update_time = 0;     // Timestamp dernière mise à jour
         private bool pending_update = false;    // Mise à jour en attente
+        private ulong message_notify_id = 0;    // Suivi des changements du message
 
         /**
          * Propriété publique pour accéder au message
          */
-        public ChatMessage get_message() {
+        public ChatMessage? get_message() {
             return message;
         }
 
         /**
-         * Crée une nouvelle bulle de message
+         * Crée une bulle vide, recyclée par la ListView
+         *
+         * Les widgets (TextView, buffer, menu contextuel) sont construits une
+         * seule fois ; bind_message() et unbind_message() ne changent que le
+         * message affiché.
          */
-        public ChatBubbleRow(ChatMessage message) {
+        public ChatBubbleRow() {
             Object(orientation: Orientation.VERTICAL, spacing: 3);
 
-            stderr.printf("🟡 CHATBUBBLEROW: Début construction\n");
-
-            // Vérification de sécurité
-            if (message == null) {
-                stderr.printf("❌ CHATBUBBLEROW: Message NULL passé au constructeur\n");
-                warning("ChatBubbleRow: Message NULL passé au constructeur");
-                return;
-            }
-
-            stderr.printf("🟡 CHATBUBBLEROW: Message reçu: '%s'\n", message.content ?? "(vide)");
-
-            this.message = message;
-
-            // Configuration en fonction du type d'émetteur
-            bool is_user = (message.sender == ChatMessage.SenderType.USER);
-
-            // Configuration visuelle de la boîte
-            this.margin_start = is_user ? 50 : 12;
-            this.margin_end = is_user ? 12 : 50;
             this.margin_top = 6;
             this.margin_bottom = 6;
-            this.halign = is_user ? Align.END : Align.START;
-
-            // Ajouter les classes CSS pour styliser
             this.add_css_class("chat-bubble");
-            this.add_css_class(is_user ? "user-bubble" : "ai-bubble");
 
             // Conteneur pour le contenu avec un style de bulle
-            var bubble_box = new Box(Orientation.VERTICAL, 3);
-            stderr.printf("🟡 CHATBUBBLEROW: bubble_box créé\n");
+            bubble_box = new Box(Orientation.VERTICAL, 3);
             bubble_box.add_css_class("bubble-content");
             bubble_box.set_hexpand(true);  // Étendre horizontalement
             bubble_box.set_halign(Align.FILL);  // Remplir l'espace disponible
 
             // Créer un TextView sélectionnable pour le contenu du message
             content_text_view = new TextView();
-            stderr.printf("🟡 CHATBUBBLEROW: content_text_view créé avec: '%s'\n", message.content ?? "(vide)");
             content_text_view.editable = false;  // En lecture seule
             content_text_view.cursor_visible = false;  // Pas de curseur
             content_text_view.wrap_mode = Gtk.WrapMode.WORD_CHAR;
@@ -72,42 +53,85 @@ namespace Sambo {
             content_text_view.set_size_request(-1, -1);  // Ajustement automatique
             content_text_view.set_hexpand(true);  // Étendre horizontalement
             content_text_view.set_halign(Align.FILL);  // Remplir l'espace disponible
-
-            // Obtenir le buffer pour définir le contenu
-            var buffer = content_text_view.get_buffer();
-
-            // Convertir le contenu Markdown et l'appliquer
-            string formatted_content = convert_markdown_to_pango(message.content ?? "");
-            stderr.printf("🎨 MARKDOWN: '%s' -> '%s'\n",
-                message.content ?? "(vide)", formatted_content);
-
-            try {
-                buffer.create_tag("markdown", "wrap-mode", Pango.WrapMode.WORD_CHAR);
-
-                // Pour l'instant, utiliser le texte brut - nous améliorerons le formatage plus tard
-                buffer.set_text(message.content ?? "", -1);
-            } catch (Error e) {
-                warning("Erreur lors de la définition du contenu du TextView: %s", e.message);
-                buffer.set_text(message.content ?? "", -1);
-            }
+            content_text_view.get_buffer().create_tag("markdown", "wrap-mode", Pango.WrapMode.WORD_CHAR);
 
             // Ajouter le menu contextuel personnalisé
             setup_context_menu();
 
             // Créer le libellé pour l'horodatage
-            time_label = new Label(message.get_formatted_stats());
-            stderr.printf("🟡 CHATBUBBLEROW: time_label créé\n");
+            time_label = new Label("");
             time_label.add_css_class("bubble-time");
-            time_label.set_halign(is_user ? Align.END : Align.START);
 
             // Ajouter les widgets au conteneur de bulle
             bubble_box.append(content_text_view);
             bubble_box.append(time_label);
-            stderr.printf("🟡 CHATBUBBLEROW: Widgets ajoutés à bubble_box\n");
 
             // Ajouter la bulle à la boîte principale
             this.append(bubble_box);
-            stderr.printf("✅ CHATBUBBLEROW: Construction terminée - bubble_box ajouté au widget principal\n");
+        }
+
+        /**
+         * Affiche un message dans la bulle et suit ses changements
+         */
+        public void bind_message(ChatMessage message) {
+            unbind_message();
+            this.message = message;
+
+            // Configuration en fonction du type d'émetteur
+            bool is_user = (message.sender == ChatMessage.SenderType.USER);
+            this.margin_start = is_user ? 50 : 12;
+            this.margin_end = is_user ? 12 : 50;
+            this.halign = is_user ? Align.END : Align.START;
+            if (is_user) {
+                this.remove_css_class("ai-bubble");
+                this.add_css_class("user-bubble");
+            } else {
+                this.remove_css_class("user-bubble");
+                this.add_css_class("ai-bubble");
+            }
+            time_label.set_halign(is_user ? Align.END : Align.START);
+
+            content_text_view.get_buffer().set_text(message.content ?? "", -1);
+            time_label.set_text(message.get_formatted_stats());
+            last_update_time = get_monotonic_time();
+
+            // Suivre le message : il peut encore changer pendant le streaming
+            message_notify_id = message.notify.connect(on_message_notify);
+        }
+
+        /**
+         * Détache la bulle de son message avant qu'elle soit réutilisée
+         */
+        public void unbind_message() {
+            if (message_notify_id != 0 && message != null) {
+                message.disconnect(message_notify_id);
+            }
+            message_notify_id = 0;
+            if (update_timeout_id != 0) {
+                Source.remove(update_timeout_id);
+                update_timeout_id = 0;
+            }
+            pending_update = false;
+            message = null;
+        }
+
+        /**
+         * Libère la connexion au message quand la bulle est détruite
+         */
+        public override void dispose() {
+            unbind_message();
+            base.dispose();
+        }
+
+        /**
+         * Rafraîchit la bulle quand le contenu ou les statistiques du message changent
+         */
+        private void on_message_notify(ParamSpec pspec) {
+            if (pspec.name == "content") {
+                update_content();
+            } else if (pspec.name == "is-processing-complete" && time_label != null) {
+                time_label.set_text(message.get_formatted_stats());
+            }
         }
 
         /**
@@ -289,8 +313,6 @@ namespace Sambo {
                 
             } catch (Error global_error) {
                 stderr.printf("[ERROR] CHATBUBBLEROW: Erreur critique dans execute_content_update: %s\n", global_error.message);
-                // En cas d'erreur critique, désactiver les futures mises à jour
-                content_text_view = null;
             }
         }
 
@@ -1,5 +1,6 @@
 using Gtk;
 using Adw;
+using Sambo.Document;
 
 namespace Sambo {
     /**
@@ -8,12 +9,14 @@ namespace Sambo {
     public class ChatView : Gtk.Box {
         private ApplicationController controller;
         private ScrolledWindow scroll;
-        private Box message_container;
+        private ListView message_list;
+        private ConversationStore conversation_store;
         private Entry message_entry;
         private Button send_button;
         private Button profile_selector_button;
         private Button profile_manager_button;
         private Button cancel_generation_button;
+        private Button new_conversation_button;
         private Label profile_label;
         private Label status_label;
         private Adw.ToastOverlay toast_overlay;
@@ -26,12 +29,19 @@ namespace Sambo {
 
         // Message en cours de génération pour le streaming
         private ChatMessage? current_ai_message = null;
-        private ChatBubbleRow? current_ai_bubble = null;
+
+        // Traitement map-reduce d'un document envoyé depuis l'éditeur
+        private LongDocumentProcessor? long_document_processor = null;
 
         // Variables pour les statistiques de traitement
         private int64 generation_start_time = 0;
         private int token_count = 0;
 
+        /**
+         * Émis quand une réponse se termine et que la saisie est de nouveau possible
+         */
+        public signal void response_finished(bool success);
+
         /**
          * Crée une nouvelle vue de chat
          */
@@ -45,15 +55,40 @@ namespace Sambo {
             // Créer la barre d'outils du chat
             create_chat_toolbar();
 
-            // Conteneur pour les messages
-            message_container = new Box(Orientation.VERTICAL, 10);
-            message_container.set_vexpand(true);
-            message_container.add_css_class("chat-messages-container"); // Debug CSS
+            // Historique persistant : les bulles ne sont créées que pour les lignes visibles
+            conversation_store = new ConversationStore();
+
+            // Les bulles sont créées une fois (setup) puis recyclées au défilement
+            var factory = new SignalListItemFactory();
+            factory.setup.connect((obj) => {
+                var list_item = obj as ListItem;
+                list_item.set_child(new ChatBubbleRow());
+            });
+            factory.bind.connect((obj) => {
+                var list_item = obj as ListItem;
+                var row = list_item.get_child() as ChatBubbleRow;
+                var message = list_item.get_item() as ChatMessage;
+                if (row != null && message != null) {
+                    row.bind_message(message);
+                }
+            });
+            factory.unbind.connect((obj) => {
+                var list_item = obj as ListItem;
+                var row = list_item.get_child() as ChatBubbleRow;
+                if (row != null) {
+                    row.unbind_message();
+                }
+            });
+
+            message_list = new ListView(new NoSelection(conversation_store), factory);
+            message_list.set_vexpand(true);
+            message_list.add_css_class("chat-messages-container");
+            message_list.add_css_class("chat-message-list");
 
             // Zone de défilement pour les messages
             scroll = new ScrolledWindow();
             scroll.set_vexpand(true);
-            scroll.set_child(message_container);
+            scroll.set_child(message_list);
 
             // Zone de saisie du message
             message_entry = new Entry();
@@ -95,11 +130,35 @@ namespace Sambo {
             var config = controller.get_config_manager();
             config.profiles_changed.connect(on_profiles_changed);
 
-            // Message de bienvenue
+            // Documents longs envoyés depuis l'éditeur
+            controller.document_sent_to_chat.connect(process_long_document);
+
+            // Message de bienvenue pour une conversation vide
+            if (conversation_store.is_empty()) {
+                add_welcome_message();
+            } else {
+                Idle.add(() => {
+                    scroll_to_bottom();
+                    return Source.REMOVE;
+                });
+            }
+        }
+
+        /**
+         * Ajoute le message de bienvenue
+         */
+        private void add_welcome_message() {
             var welcome = new ChatMessage("Bonjour ! Comment puis-je vous aider aujourd'hui ?", ChatMessage.SenderType.AI);
             add_message(welcome);
         }
 
+        /**
+         * Retourne l'historique persistant de la conversation
+         */
+        public ConversationStore get_conversation_store() {
+            return conversation_store;
+        }
+
         // Modèle actuellement en cours de chargement pour éviter les doublons
         private string? loading_model_path = null;
 
@@ -111,6 +170,10 @@ namespace Sambo {
             current_profile = config.get_selected_profile();
             update_profile_display();
 
+            // Les adaptateurs LoRA du profil s'attachent sans recharger le modèle de base
+            controller.get_model_manager().set_session_adapters(
+                current_profile != null ? current_profile.lora_adapters : new Gee.ArrayList<LoraAdapter>());
+
             // Charger automatiquement le modèle du profil sélectionné
             if (current_profile != null && current_profile.model_path != null && current_profile.model_path != "") {
                 var model_manager = controller.get_model_manager();
@@ -132,6 +195,7 @@ namespace Sambo {
                 status_label.set_text("Chargement du modèle...");
 
                 // Le résultat du chargement sera géré par les signaux model_loaded/model_load_failed
+                model_manager.set_context_options(current_profile);
                 model_manager.load_model(current_profile.model_path);
             }
         }
@@ -270,6 +334,14 @@ namespace Sambo {
             spacer.set_hexpand(true);
             toolbar.append(spacer);
 
+            // Bouton de nouvelle conversation (l'historique courant est archivé)
+            new_conversation_button = new Button();
+            new_conversation_button.add_css_class("flat");
+            new_conversation_button.set_icon_name("document-new-symbolic");
+            new_conversation_button.set_tooltip_text("Nouvelle conversation");
+            new_conversation_button.clicked.connect(on_new_conversation_clicked);
+            toolbar.append(new_conversation_button);
+
             // Bouton d'annulation de génération
             cancel_generation_button = new Button();
             cancel_generation_button.add_css_class("cancel-generation-button");
@@ -284,6 +356,18 @@ namespace Sambo {
             this.append(toolbar);
         }
 
+        /**
+         * Archive la conversation courante et en démarre une nouvelle
+         */
+        private void on_new_conversation_clicked() {
+            if (is_processing) {
+                show_toast("Une génération est en cours");
+                return;
+            }
+            conversation_store.start_new_conversation();
+            add_welcome_message();
+        }
+
         /**
          * Gestionnaire pour le clic sur le sélecteur de profil
          */
@@ -480,6 +564,14 @@ namespace Sambo {
             return button;
         }
 
+        /**
+         * Envoie un message comme s'il avait été saisi par l'utilisateur
+         */
+        public void send_message(string text) {
+            message_entry.set_text(text);
+            on_send_message();
+        }
+
         /**
          * Gestionnaire pour l'envoi d'un message
          */
@@ -558,8 +650,7 @@ namespace Sambo {
 
             // Créer le message IA (vide pour le moment)
             current_ai_message = new ChatMessage("", ChatMessage.SenderType.AI);
-            current_ai_bubble = new ChatBubbleRow(current_ai_message);
-            message_container.append(current_ai_bubble);
+            conversation_store.append_live(current_ai_message);
 
             // Initialiser les statistiques de traitement
             generation_start_time = get_monotonic_time();
@@ -579,6 +670,106 @@ namespace Sambo {
             generate_real_ai_response(full_context, sampling_params);
         }
 
+        /**
+         * Traite un document long envoyé depuis l'éditeur
+         *
+         * Le texte saisi dans le champ de message sert de consigne ; les
+         * étapes du map-reduce sont suivies dans la barre d'état et la réponse
+         * finale est diffusée dans une bulle comme une génération normale.
+         */
+        private void process_long_document(PivotDocument document, string title) {
+            if (is_processing) {
+                show_toast("Une génération est déjà en cours");
+                return;
+            }
+            if (current_profile == null || !current_profile.is_valid()) {
+                show_toast("Veuillez sélectionner un profil d'inférence valide");
+                return;
+            }
+
+            var model_manager = controller.get_model_manager();
+            // Le modèle chargé peut être celui d'un autre profil
+            if (!model_manager.is_model_ready() || model_manager.get_current_model_path() != current_profile.model_path) {
+                if (current_profile.model_path == "" || !FileUtils.test(current_profile.model_path, FileTest.EXISTS)) {
+                    show_toast("Modèle du profil introuvable");
+                    return;
+                }
+                model_manager.set_context_options(current_profile);
+                if (!model_manager.load_model(current_profile.model_path)) {
+                    show_toast("Impossible de charger le modèle du profil");
+                    return;
+                }
+            }
+
+            string instruction = message_entry.get_text().strip();
+            if (instruction == "") {
+                instruction = "Résume ce document.";
+            }
+            message_entry.set_text("");
+
+            add_message(new ChatMessage("📄 %s — %s".printf(title, instruction), ChatMessage.SenderType.USER));
+
+            is_generation_cancelled = false;
+            is_processing = true;
+            status_label.set_text("Découpage du document...");
+            progress_bar.set_visible(true);
+            progress_bar.set_fraction(0.0);
+            cancel_generation_button.set_visible(true);
+            send_button.set_sensitive(false);
+            message_entry.set_sensitive(false);
+
+            var ai_message = new ChatMessage("", ChatMessage.SenderType.AI);
+            current_ai_message = ai_message;
+            conversation_store.append_live(ai_message);
+            scroll_to_bottom();
+
+            generation_start_time = get_monotonic_time();
+            token_count = 0;
+
+            var processor = new LongDocumentProcessor(model_manager, current_profile);
+            long_document_processor = processor;
+
+            processor.chunking_done.connect((chunk_count, parallel) => {
+                status_label.set_text("%d sections, %d en parallèle".printf(chunk_count, parallel));
+            });
+            processor.map_progress.connect((completed, total) => {
+                status_label.set_text("Analyse des sections %d/%d".printf(completed, total));
+                progress_bar.set_fraction((double) completed / total);
+            });
+            processor.reduce_started.connect((partial_count) => {
+                status_label.set_text("Synthèse de %d réponses partielles...".printf(partial_count));
+                progress_bar.pulse();
+            });
+            processor.token_received.connect((token) => {
+                if (long_document_processor != processor) {
+                    return;
+                }
+                ai_message.content += token;
+                token_count++;
+                progress_bar.pulse();
+                scroll_to_bottom();
+            });
+            processor.finished.connect((success, error_message) => {
+                // Annulé depuis l'interface : l'état a déjà été restauré
+                if (long_document_processor != processor) {
+                    return;
+                }
+                long_document_processor = null;
+
+                if (!success) {
+                    ai_message.content = "❌ **_Échec du traitement du document_**\n\n**Cause :** %s".printf(error_message ?? "erreur inconnue");
+                } else {
+                    double duration = (get_monotonic_time() - generation_start_time) / 1000000.0;
+                    ai_message.set_processing_stats(token_count, duration);
+                }
+                conversation_store.commit_live();
+                force_unlock_ui();
+                message_entry.grab_focus();
+            });
+
+            processor.start(document, instruction);
+        }
+
         /**
          * Crée les paramètres de sampling depuis le profil
          */
@@ -593,7 +784,9 @@ namespace Sambo {
                 presence_penalty = profile.presence_penalty,
                 seed = profile.seed,
                 context_length = profile.context_length,
-                stream = profile.stream
+                stream = profile.stream,
+                kv_cache_type = profile.get_kv_cache_type(),
+                flash_attention = profile.flash_attention
             };
 
             stderr.printf("[TRACE][OUT] CHATVIEW: Paramètres créés - stream = %s\n",
@@ -637,9 +830,10 @@ namespace Sambo {
         private void generate_real_ai_response(string context, Llama.SamplingParams params) {
             // Vérifier qu'un modèle est chargé
             var model_manager = controller.get_model_manager();
-            if (!model_manager.is_model_ready()) {
+            if (!model_manager.is_model_ready() || model_manager.get_current_model_path() != current_profile.model_path) {
                 // Tenter de charger le modèle du profil
                 if (current_profile.model_path != "" && FileUtils.test(current_profile.model_path, FileTest.EXISTS)) {
+                    model_manager.set_context_options(current_profile);
                     if (!model_manager.load_model(current_profile.model_path)) {
                         show_error_response("❌ **_Erreur de chargement de modèle_**\n\n**Cause :** Impossible de charger le modèle `" + current_profile.model_path + "`\n\n**Solution :** Vérifiez que le fichier de modèle est accessible et compatible.");
                         return;
@@ -690,32 +884,20 @@ namespace Sambo {
 
                     // Protection critique contre les erreurs de segmentation
                     try {
-                        // Vérifier que l'interface n'a pas été détruite et qu'on traite toujours le bon message
-                        if (current_ai_message != null && current_ai_bubble != null && !is_generation_cancelled) {
+                        // Vérifier qu'on traite toujours le bon message
+                        if (current_ai_message != null && !is_generation_cancelled) {
                             stderr.printf("[TRACE][IN] CHATVIEW: Interface disponible, mise à jour...\n");
 
-                            // Vérification supplémentaire des pointeurs
-                            if (current_ai_message.is_floating() == false && current_ai_bubble.is_floating() == false) {
-                                // Si une erreur a été détectée, afficher le message d'erreur au lieu de la réponse
-                                if (ai_error_detected && is_finished) {
-                                    current_ai_message.content = ai_error_message;
-                                } else if (!ai_error_detected) {
-                                    // Mettre à jour le contenu du message seulement si pas d'erreur détectée
-                                    current_ai_message.content = partial_response;
-                                }
-
-                                stderr.printf("[TRACE][OUT] CHATVIEW: Message mis à jour, appel update_content()\n");
-
-                                // Utiliser une minuterie pour éviter les problèmes de concurrence
-                                Idle.add(() => {
-                                    if (current_ai_bubble != null && !current_ai_bubble.is_floating()) {
-                                        current_ai_bubble.update_content();
-                                    }
-                                    return Source.REMOVE;
-                                });
-                            } else {
-                                stderr.printf("[WARNING] CHATVIEW: Widgets détachés détectés, annulation de la mise à jour\n");
+                            // Si une erreur a été détectée, afficher le message d'erreur au lieu de la réponse
+                            // La bulle visible (s'il y en a une) suit le message via notify::content
+                            if (ai_error_detected && is_finished) {
+                                current_ai_message.content = ai_error_message;
+                            } else if (!ai_error_detected) {
+                                // Mettre à jour le contenu du message seulement si pas d'erreur détectée
+                                current_ai_message.content = partial_response;
                             }
+
+                            stderr.printf("[TRACE][OUT] CHATVIEW: Message mis à jour\n");
                         } else {
                             stderr.printf("[TRACE][IN] CHATVIEW: Interface non disponible ou génération annulée\n");
                         }
@@ -754,10 +936,11 @@ namespace Sambo {
                             int64 generation_end_time = get_monotonic_time();
                             double duration = (generation_end_time - generation_start_time) / 1000000.0; // en secondes
 
-                            // Mettre à jour les statistiques dans la bulle
-                            if (current_ai_bubble != null && !current_ai_bubble.is_floating()) {
-                                current_ai_bubble.update_processing_stats(token_count, duration);
+                            // Mettre à jour les statistiques puis écrire le message dans l'historique
+                            if (current_ai_message != null) {
+                                current_ai_message.set_processing_stats(token_count, duration);
                             }
+                            conversation_store.commit_live();
 
                             // Arrêter le chronomètre dans le CommunicationView
                             var parent_widget = this.get_parent();
@@ -784,7 +967,6 @@ namespace Sambo {
 
                             // Nettoyer les références
                             current_ai_message = null;
-                            current_ai_bubble = null;
 
                             // Masquer les indicateurs de progression et réactiver l'envoi (de manière sécurisée)
                             if (progress_bar != null && !progress_bar.is_floating()) {
@@ -800,6 +982,8 @@ namespace Sambo {
                                 message_entry.set_sensitive(true);
                                 message_entry.grab_focus();
                             }
+
+                            response_finished(!ai_error_detected);
                         } catch (Error finish_error) {
                             stderr.printf("[ERROR] CHATVIEW: Erreur lors de la finalisation: %s\n", finish_error.message);
                         }
@@ -824,16 +1008,15 @@ namespace Sambo {
                 ((CommunicationView)parent_widget).stop_execution_timer();
             }
 
-            if (current_ai_message != null && current_ai_bubble != null) {
+            if (current_ai_message != null) {
                 current_ai_message.content = error_message;
-                current_ai_bubble.update_content();
                 scroll_to_bottom();
             }
+            conversation_store.commit_live();
 
             is_processing = false;
             status_label.set_text("❌ Erreur");
             current_ai_message = null;
-            current_ai_bubble = null;
 
             // Masquer les indicateurs de progression et réactiver l'envoi
             progress_bar.set_visible(false);
@@ -852,6 +1035,7 @@ namespace Sambo {
                 }
             }
             show_toast(toast_message);
+            response_finished(false);
         }
 
         /**
@@ -916,26 +1100,13 @@ namespace Sambo {
                 return;
             }
 
-            stderr.printf("🔵 CHATVIEW: Création ChatBubbleRow pour message: '%s'\n", message.content ?? "(vide)");
+            stderr.printf("🔵 CHATVIEW: Ajout à l'historique du message: '%s'\n", message.content ?? "(vide)");
 
-            // Créer et ajouter la bulle de message
-            var bubble = new ChatBubbleRow(message);
+            // Écrire le message dans l'historique ; la ListView crée la bulle si la ligne est visible
+            conversation_store.append(message);
 
-            stderr.printf("🔵 CHATVIEW: ChatBubbleRow créé, ajout au message_container\n");
-            message_container.append(bubble);
-
-            stderr.printf("🔵 CHATVIEW: Message ajouté au conteneur, nombre d'enfants: %u\n",
-                message_container.get_first_child() != null ? 1 : 0);
-
-            // Forcer l'affichage des widgets
-            message_container.set_visible(true);
-            bubble.set_visible(true);
-            scroll.set_visible(true);
-
-            stderr.printf("🔵 CHATVIEW: Visibilité forcée - container: %s, bubble: %s, scroll: %s\n",
-                message_container.get_visible() ? "VISIBLE" : "MASQUÉ",
-                bubble.get_visible() ? "VISIBLE" : "MASQUÉ",
-                scroll.get_visible() ? "VISIBLE" : "MASQUÉ");
+            stderr.printf("🔵 CHATVIEW: Message ajouté à l'historique, nombre de messages: %u\n",
+                conversation_store.get_n_items());
 
             // Faire défiler vers le bas
             Idle.add(() => {
@@ -974,6 +1145,7 @@ namespace Sambo {
 
                 // Charger le modèle du profil si nécessaire
                 if (FileUtils.test(current_profile.model_path, FileTest.EXISTS)) {
+                    model_manager.set_context_options(current_profile);
                     model_manager.load_model(current_profile.model_path);
                 } else {
                     // Modèle introuvable, mais ne pas afficher de message de debug
@@ -1000,16 +1172,20 @@ namespace Sambo {
                     ((CommunicationView)parent_widget).stop_execution_timer();
                 }
 
-                // Forcer la mise à jour de l'état AVANT d'annuler
-                force_unlock_ui();
-
-                // Marquer le message AI actuel comme annulé
+                // Marquer le message AI actuel comme annulé et l'écrire dans l'historique
                 if (current_ai_message != null) {
                     current_ai_message.content = "⏹️ Génération annulée par l'utilisateur";
-                    if (current_ai_bubble != null) {
-                        current_ai_bubble.update_content();
-                    }
                 }
+                conversation_store.commit_live();
+
+                // Un document long en cours est abandonné : ses signaux restants sont ignorés
+                if (long_document_processor != null) {
+                    long_document_processor.cancel();
+                    long_document_processor = null;
+                }
+
+                // Forcer la mise à jour de l'état AVANT d'annuler
+                force_unlock_ui();
 
                 show_toast("⏹️ Génération annulée");
 
@@ -1056,7 +1232,6 @@ namespace Sambo {
 
             // Nettoyer les références
             current_ai_message = null;
-            current_ai_bubble = null;
         }
     }
 }
@@ -36,6 +36,11 @@ namespace Sambo {
         private int only_left_files = 0;
         private int only_right_files = 0;
 
+        // Comparaison récursive en cours et index des éléments par chemin relatif
+        private DirectoryComparer? comparer = null;
+        private Gee.HashMap<string, FileItemModel> left_items = new Gee.HashMap<string, FileItemModel>();
+        private Gee.HashMap<string, FileItemModel> right_items = new Gee.HashMap<string, FileItemModel>();
+
         // Boutons pour les opérations multiples
         private Button sync_all_button;
         private MenuButton filter_button;
@@ -80,69 +85,28 @@ namespace Sambo {
         private void setup_filters() {
             // Filtre pour masquer les fichiers identiques si demandé
             left_filter = new CustomFilter((obj) => {
-                bool show_identical = show_identical_button.get_active();
-                var file_item = obj as FileItemModel;
-
-                if (file_item == null) {
-                    return false;
-                }
-
-                // Si on montre tous les fichiers, pas besoin de filtrer
-                if (show_identical) {
-                    return true;
-                }
-
-                // Vérifier si ce fichier existe dans la liste de droite
-                string filename = file_item.name;
-                bool found_identical = false;
-
-                for (uint i = 0; i < right_store.get_n_items(); i++) {
-                    var right_item = right_store.get_item(i) as FileItemModel;
-                    if (right_item != null && right_item.name == filename) {
-                        // Vérifier si les fichiers sont identiques (taille + date)
-                        if (right_item.size == file_item.size &&
-                            right_item.modified_time.compare(file_item.modified_time) == 0) {
-                            found_identical = true;
-                            break;
-                        }
-                    }
-                }
-
-                // Retourner true si pas identique ou si c'est un dossier
-                return !found_identical || file_item.is_directory();
+                return filter_item(obj as FileItemModel);
             });
 
             // Filtre pour la liste de droite (même logique)
             right_filter = new CustomFilter((obj) => {
-                bool show_identical = show_identical_button.get_active();
-                var file_item = obj as FileItemModel;
-
-                if (file_item == null) {
-                    return false;
-                }
-
-                if (show_identical) {
-                    return true;
-                }
-
-                string filename = file_item.name;
-                bool found_identical = false;
-
-                for (uint i = 0; i < left_store.get_n_items(); i++) {
-                    var left_item = left_store.get_item(i) as FileItemModel;
-                    if (left_item != null && left_item.name == filename) {
-                        if (left_item.size == file_item.size &&
-                            left_item.modified_time.compare(file_item.modified_time) == 0) {
-                            found_identical = true;
-                            break;
-                        }
-                    }
-                }
-
-                return !found_identical || file_item.is_directory();
+                return filter_item(obj as FileItemModel);
             });
         }
 
+        /**
+         * Masque les fichiers identiques si demandé, d'après le statut calculé
+         */
+        private bool filter_item(FileItemModel? file_item) {
+            if (file_item == null) {
+                return false;
+            }
+            if (show_identical_button.get_active()) {
+                return true;
+            }
+            return file_item.get_metadata("comparison") != "identical";
+        }
+
         /**
          * Crée l'interface utilisateur
          */
@@ -519,7 +483,10 @@ namespace Sambo {
                 size_label.set_text(file_item.get_formatted_size());
                 date_label.set_text(file_item.get_formatted_modified_time());
 
-                // Colorer différemment les fichiers différents
+                // Colorer différemment les fichiers différents (les lignes sont recyclées)
+                box.remove_css_class("comparison-only-here");
+                box.remove_css_class("comparison-different");
+                box.remove_css_class("comparison-identical");
                 string? status = get_comparison_status(file_item, is_left);
                 if (status != null) {
                     if (status == "only_here") {
@@ -552,19 +519,10 @@ namespace Sambo {
                     var item = item_selection.get_selected_item() as FileItemModel;
                     if (item != null && !item.is_directory()) {
                         // Trouver le fichier correspondant dans l'autre liste
-                        var other_store = is_left ? right_store : left_store;
-                        FileItemModel? other_item = null;
-
-                        for (uint i = 0; i < other_store.get_n_items(); i++) {
-                            var file = other_store.get_item(i) as FileItemModel;
-                            if (file != null && file.name == item.name && !file.is_directory()) {
-                                other_item = file;
-                                break;
-                            }
-                        }
+                        var other_item = (is_left ? right_items : left_items)[item.name];
 
                         // Si l'autre fichier existe, comparer les deux
-                        if (other_item != null) {
+                        if (other_item != null && !other_item.is_directory()) {
                             string left_file = is_left ? item.path : other_item.path;
                             string right_file = is_left ? other_item.path : item.path;
                             file_diff_requested(left_file, right_file);
@@ -578,9 +536,16 @@ namespace Sambo {
         }
 
         /**
-         * Charge le contenu des deux répertoires
+         * Lance la comparaison récursive des deux répertoires
+         *
+         * Les résultats arrivent par lots depuis DirectoryComparer ; l'interface
+         * reste utilisable pendant le parcours.
          */
         private void load_directory_content() {
+            if (comparer != null) {
+                comparer.cancel();
+            }
+
             // Réinitialiser les compteurs
             total_files = 0;
             identical_files = 0;
@@ -588,94 +553,83 @@ namespace Sambo {
             only_left_files = 0;
             only_right_files = 0;
 
-            // Charger le contenu du répertoire de gauche
             left_store.remove_all();
-            try {
-                load_directory(left_path, left_store);
-            } catch (Error e) {
-                warning("Erreur lors du chargement du répertoire gauche: %s", e.message);
-            }
-
-            // Charger le contenu du répertoire de droite
             right_store.remove_all();
-            try {
-                load_directory(right_path, right_store);
-            } catch (Error e) {
-                warning("Erreur lors du chargement du répertoire droit: %s", e.message);
-            }
-
-            // Analyser les différences pour les statistiques
-            calculate_statistics();
+            left_items.clear();
+            right_items.clear();
 
-            // Mettre à jour l'affichage
-            apply_filters();
+            comparer = new DirectoryComparer(left_path, right_path);
+            comparer.entries_found.connect(on_entries_found);
+            comparer.comparison_finished.connect(on_comparison_finished);
+            comparer.start();
 
-            // Mettre à jour les statistiques dans l'interface
             update_statistics_label();
         }
 
         /**
-         * Calcule les statistiques de comparaison entre les deux répertoires
+         * Ajoute un lot de résultats aux deux listes
          */
-        private void calculate_statistics() {
-            total_files = 0;
-            identical_files = 0;
-            different_files = 0;
-            only_left_files = 0;
-            only_right_files = 0;
+        private void on_entries_found(DirectoryComparer source, Gee.List<ComparisonEntry> entries) {
+            if (source != comparer) {
+                return;
+            }
 
-            // Parcourir le répertoire de gauche
-            for (uint i = 0; i < left_store.get_n_items(); i++) {
-                var left_item = left_store.get_item(i) as FileItemModel;
-                if (left_item == null) continue;
+            Object[] new_left = {};
+            Object[] new_right = {};
 
+            foreach (var entry in entries) {
                 total_files++;
-
-                bool found = false;
-
-                // Chercher le fichier correspondant à droite
-                for (uint j = 0; j < right_store.get_n_items(); j++) {
-                    var right_item = right_store.get_item(j) as FileItemModel;
-                    if (right_item != null && right_item.name == left_item.name) {
-                        found = true;
-
-                        // Vérifier si identique (taille et date)
-                        if (right_item.size == left_item.size &&
-                            right_item.modified_time.compare(left_item.modified_time) == 0) {
-                            identical_files++;
-                        } else {
-                            different_files++;
-                        }
-
+                string status;
+                switch (entry.status) {
+                    case ComparisonStatus.IDENTICAL:
+                        identical_files++;
+                        status = "identical";
+                        break;
+                    case ComparisonStatus.DIFFERENT:
+                        different_files++;
+                        status = "different";
+                        break;
+                    case ComparisonStatus.ONLY_LEFT:
+                        only_left_files++;
+                        status = "only_here";
+                        break;
+                    default:
+                        only_right_files++;
+                        status = "only_here";
                         break;
-                    }
                 }
 
-                if (!found) {
-                    only_left_files++;
+                // Le nom affiché est le chemin relatif, commun aux deux côtés
+                if (entry.left != null) {
+                    entry.left.name = entry.relative_path;
+                    entry.left.set_metadata("comparison", status);
+                    left_items[entry.relative_path] = entry.left;
+                    new_left += entry.left;
+                }
+                if (entry.right != null) {
+                    entry.right.name = entry.relative_path;
+                    entry.right.set_metadata("comparison", status);
+                    right_items[entry.relative_path] = entry.right;
+                    new_right += entry.right;
                 }
             }
 
-            // Parcourir le répertoire de droite pour trouver les fichiers uniquement présents à droite
-            for (uint i = 0; i < right_store.get_n_items(); i++) {
-                var right_item = right_store.get_item(i) as FileItemModel;
-                if (right_item == null) continue;
-
-                bool found = false;
-
-                for (uint j = 0; j < left_store.get_n_items(); j++) {
-                    var left_item = left_store.get_item(j) as FileItemModel;
-                    if (left_item != null && left_item.name == right_item.name) {
-                        found = true;
-                        break;
-                    }
-                }
+            left_store.splice(left_store.get_n_items(), 0, new_left);
+            right_store.splice(right_store.get_n_items(), 0, new_right);
+            update_statistics_label();
+        }
 
-                if (!found) {
-                    only_right_files++;
-                    total_files++; // Ajouter au total car non compté précédemment
-                }
+        /**
+         * Trie les listes une fois la comparaison terminée
+         */
+        private void on_comparison_finished(DirectoryComparer source, bool cancelled) {
+            if (source != comparer) {
+                return;
+            }
+            if (!cancelled) {
+                sort_files_by("name");
             }
+            update_statistics_label();
         }
 
         /**
@@ -688,69 +642,12 @@ namespace Sambo {
             stats_label.set_text(stats_text);
         }
 
-        /**
-         * Charge le contenu d'un répertoire dans un ListStore
-         */
-        private void load_directory(string path, GLib.ListStore store) throws Error {
-            var directory = File.new_for_path(path);
-            var enumerator = directory.enumerate_children(
-                "standard::*,time::modified,unix::mode",
-                FileQueryInfoFlags.NONE
-            );
-
-            FileInfo info;
-            while ((info = enumerator.next_file()) != null) {
-                var file_path = Path.build_filename(path, info.get_name());
-                var item = new FileItemModel.from_file_info(file_path, info);
-                store.append(item);
-            }
-
-            // Trier: d'abord les dossiers, puis les fichiers, par ordre alphabétique
-            store.sort((a, b) => {
-                var file_a = a as FileItemModel;
-                var file_b = b as FileItemModel;
-
-                if (file_a.is_directory() && !file_b.is_directory())
-                    return -1;
-                if (!file_a.is_directory() && file_b.is_directory())
-                    return 1;
-                return file_a.name.collate(file_b.name);
-            });
-        }
-
         /**
          * Détermine le statut de comparaison d'un fichier
          * @return "only_here", "different", "identical" ou null
          */
         private string? get_comparison_status(FileItemModel file_item, bool is_left) {
-            var store_to_check = is_left ? right_store : left_store;
-            string file_name = file_item.name;
-
-            bool found = false;
-            bool identical = false;
-
-            for (uint i = 0; i < store_to_check.get_n_items(); i++) {
-                var other_item = store_to_check.get_item(i) as FileItemModel;
-                if (other_item != null && other_item.name == file_name) {
-                    found = true;
-
-                    // Vérifier si les fichiers sont identiques (taille + date)
-                    if (other_item.size == file_item.size &&
-                        other_item.modified_time.compare(file_item.modified_time) == 0) {
-                        identical = true;
-                    }
-
-                    break;
-                }
-            }
-
-            if (!found) {
-                return "only_here";
-            } else if (identical) {
-                return "identical";
-            } else {
-                return "different";
-            }
+            return file_item.get_metadata("comparison");
         }
 
         /**
@@ -852,22 +749,11 @@ namespace Sambo {
                     var source_file = File.new_for_path(source_path);
                     var target_file_obj = File.new_for_path(target_file);
 
-                    // Vérifier si le fichier existe et s'il est différent
-                    bool should_copy = true;
-
-                    if (target_file_obj.query_exists()) {
-                        var info = target_file_obj.query_info(
-                            "standard::size,time::modified",
-                            FileQueryInfoFlags.NONE
-                        );
-
-                        if (info.get_size() == file_item.size &&
-                            info.get_modification_date_time().compare(file_item.modified_time) == 0) {
-                            should_copy = false; // Les fichiers sont identiques
-                        }
-                    }
+                    // Les fichiers identiques (contenu vérifié par empreinte) sont ignorés
+                    bool should_copy = file_item.get_metadata("comparison") != "identical";
 
                     if (should_copy) {
+                        ensure_parent_directory(target_file_obj);
                         source_file.copy(target_file_obj, FileCopyFlags.OVERWRITE, null, null);
                         success_count++;
                     }
@@ -966,6 +852,7 @@ namespace Sambo {
                 }
 
                 // Copier le fichier
+                ensure_parent_directory(dest_file);
                 source_file.copy(dest_file, FileCopyFlags.OVERWRITE, null, null);
 
                 // Rafraîchir l'affichage
@@ -982,6 +869,16 @@ namespace Sambo {
             }
         }
 
+        /**
+         * Crée le dossier parent d'un fichier de destination (chemins relatifs imbriqués)
+         */
+        private void ensure_parent_directory(File file) throws Error {
+            var parent = file.get_parent();
+            if (parent != null && !parent.query_exists()) {
+                parent.make_directory_with_parents();
+            }
+        }
+
         /**
          * Affiche un dialogue de confirmation
          */
@@ -1051,5 +948,13 @@ namespace Sambo {
             // Remplacer dialog.run() qui n'existe plus
             return response_id == "save";
         }
+
+        public override void dispose() {
+            if (comparer != null) {
+                comparer.cancel();
+                comparer = null;
+            }
+            base.dispose();
+        }
     }
 }
@@ -18,6 +18,15 @@ namespace Sambo {
         private ScrolledWindow text_scroll;
         private Box placeholder_box;
         private ApplicationController controller;
+        private Cancellable? load_cancellable = null;
+
+        private const int PREVIEW_MAX_BYTES = 64 * 1024;
+        private const int IMAGE_SIZE_STEP = 256;
+        private const int THUMBNAIL_MAX_SIZE = 256;
+        private const int DECODE_THREADS = 2;
+
+        // Pool partagé par tous les aperçus pour le décodage des images
+        private static ThreadPool<DecodeJob>? decode_pool = null;
 
         /**
          * Crée un nouveau widget de prévisualisation de fichier
@@ -71,6 +80,10 @@ namespace Sambo {
             text_view.set_monospace(true);
             text_view.add_css_class("preview-text");
 
+            buffer.create_tag("keyword", "foreground", "#0000FF", "weight", Pango.Weight.BOLD);
+            buffer.create_tag("string", "foreground", "#AA2222");
+            buffer.create_tag("comment", "foreground", "#227722", "style", Pango.Style.ITALIC);
+
             text_scroll.set_child(text_view);
             preview_stack.add_named(text_scroll, "text");
 
@@ -115,6 +128,10 @@ namespace Sambo {
 
         /**
          * Prévisualise un fichier
+         *
+         * L'en-tête est mis à jour immédiatement ; le contenu est chargé de
+         * façon asynchrone. Une nouvelle sélection annule le chargement en
+         * cours, pour que la navigation au clavier ne reste jamais bloquée.
          * @param file Le fichier à prévisualiser
          */
         public void preview_file(FileItemModel file) {
@@ -144,65 +161,210 @@ namespace Sambo {
                 file_icon.set_from_icon_name("text-x-generic");
             }
 
-            // Essayer de prévisualiser le contenu
+            cancel_pending_load();
+
+            // Pas de prévisualisation pour les dossiers
             if (file.is_directory()) {
-                // Pas de prévisualisation pour les dossiers
                 preview_stack.set_visible_child_name("placeholder");
-            } else {
-                // Déterminer le type de fichier
-                try {
-                    var file_info = File.new_for_path(file.path).query_info(
-                        "standard::content-type", FileQueryInfoFlags.NONE);
-                    string content_type = file_info.get_content_type();
-
-                    if (content_type.contains("image/")) {
-                        // Prévisualiser l'image
-                        try {
-                            var pixbuf = new Gdk.Pixbuf.from_file(file.path);
-                            image_view.set_pixbuf(pixbuf);
-                            preview_stack.set_visible_child_name("image");
-                        } catch (Error e) {
-                            warning("Erreur lors du chargement de l'image: %s", e.message);
-                            preview_stack.set_visible_child_name("placeholder");
-                        }
-                    } else if (content_type.contains("text/") ||
-                              content_type.contains("application/json") ||
-                              content_type.contains("application/xml")) {
-                        // Prévisualiser le texte
-                        try {
-                            string text;
-                            FileUtils.get_contents(file.path, out text);
-
-                            // Limiter la taille du texte prévisualisé pour les performances
-                            if (text.length > 10000) {
-                                text = text.substring(0, 10000) + "\n\n[...] Le fichier est trop grand pour être affiché en entier.";
-                            }
-
-                            buffer.set_text(text, -1);
-                            preview_stack.set_visible_child_name("text");
-                        } catch (Error e) {
-                            warning("Erreur lors de la lecture du fichier: %s", e.message);
-                            preview_stack.set_visible_child_name("placeholder");
-                        }
-                    } else {
-                        // Type de fichier non prévisualisable
-                        preview_stack.set_visible_child_name("placeholder");
-                    }
-                } catch (Error e) {
+                return;
+            }
+
+            load_cancellable = new Cancellable();
+            load_preview.begin(file, load_cancellable);
+        }
+
+        /**
+         * Annule le chargement de l'aperçu précédent
+         */
+        private void cancel_pending_load() {
+            if (load_cancellable != null) {
+                load_cancellable.cancel();
+                load_cancellable = null;
+            }
+        }
+
+        /**
+         * Charge le contenu de l'aperçu : cache, puis lecture bornée ou décodage d'image
+         */
+        private async void load_preview(FileItemModel item, Cancellable cancellable) {
+            var start_time = get_monotonic_time();
+            var file = File.new_for_path(item.path);
+
+            FileInfo info;
+            try {
+                info = yield file.query_info_async(
+                    "standard::content-type,standard::size,time::modified,time::modified-usec,thumbnail::path",
+                    FileQueryInfoFlags.NONE, Priority.DEFAULT, cancellable);
+            } catch (Error e) {
+                if (!(e is IOError.CANCELLED)) {
                     warning("Erreur lors de la détermination du type de fichier: %s", e.message);
                     preview_stack.set_visible_child_name("placeholder");
                 }
+                return;
+            }
+
+            string content_type = info.get_content_type() ?? "";
+            bool is_image = content_type.contains("image/");
+            int target_size = is_image ? get_image_target_size() : 0;
+            var modified = info.get_modification_date_time();
+            string key = "%s|%lld|%lld|%d".printf(item.path,
+                modified != null ? modified.to_unix() * 1000000 + modified.get_microsecond() : 0,
+                info.get_size(), target_size);
+
+            var cached = PreviewCache.get_default().lookup(key);
+            if (cached != null) {
+                show_result(cached, item);
+                stderr.printf("[PERF] PREVIEW: %s servi depuis le cache\n", item.name);
+                return;
+            }
+
+            PreviewResult? result = null;
+            try {
+                if (is_image) {
+                    string? thumbnail = info.get_attribute_byte_string(FileAttribute.THUMBNAIL_PATH);
+                    result = yield decode_image(item.path, thumbnail, target_size, cancellable);
+                } else if (is_text_content(content_type, item)) {
+                    result = yield read_text(file, cancellable);
+                } else {
+                    result = new PreviewResult();
+                }
+            } catch (Error e) {
+                if (e is IOError.CANCELLED) {
+                    return;
+                }
+                warning("Erreur lors du chargement de l'aperçu: %s", e.message);
+                result = new PreviewResult();
+            }
+
+            if (cancellable.is_cancelled()) {
+                return;
+            }
+
+            PreviewCache.get_default().insert(key, result);
+            show_result(result, item);
+            stderr.printf("[PERF] PREVIEW: %s chargé en %.1f ms\n",
+                item.name, (get_monotonic_time() - start_time) / 1000.0);
+        }
+
+        private void show_result(PreviewResult result, FileItemModel item) {
+            switch (result.kind) {
+                case PreviewKind.TEXT:
+                    string text = result.text;
+                    if (result.truncated) {
+                        text += "\n\n[...] Le fichier est trop grand pour être affiché en entier.";
+                    }
+                    buffer.set_text(text, -1);
+                    apply_syntax_highlighting(item.get_extension());
+                    preview_stack.set_visible_child_name("text");
+                    break;
+                case PreviewKind.IMAGE:
+                    image_view.set_paintable(result.texture);
+                    preview_stack.set_visible_child_name("image");
+                    break;
+                default:
+                    preview_stack.set_visible_child_name("placeholder");
+                    break;
+            }
+        }
+
+        /**
+         * Taille de décodage des images : celle de la zone d'aperçu, arrondie
+         * au palier supérieur pour partager les entrées du cache
+         */
+        private int get_image_target_size() {
+            int size = int.max(preview_stack.get_width(), preview_stack.get_height()) * get_scale_factor();
+            if (size <= 0) {
+                size = IMAGE_SIZE_STEP * 2;
+            }
+            return ((size + IMAGE_SIZE_STEP - 1) / IMAGE_SIZE_STEP) * IMAGE_SIZE_STEP;
+        }
+
+        private bool is_text_content(string content_type, FileItemModel item) {
+            return content_type.contains("text/") ||
+                   content_type.contains("application/json") ||
+                   content_type.contains("application/xml") ||
+                   is_previewable_text_file(item);
+        }
+
+        /**
+         * Lit au plus PREVIEW_MAX_BYTES, coupés sur une frontière de caractère UTF-8
+         */
+        private async PreviewResult read_text(File file, Cancellable cancellable) throws Error {
+            var stream = yield file.read_async(Priority.DEFAULT, cancellable);
+            var data = new uint8[PREVIEW_MAX_BYTES + 1];
+            size_t bytes_read;
+            yield stream.read_all_async(data[0:PREVIEW_MAX_BYTES], Priority.DEFAULT, cancellable, out bytes_read);
+
+            // Un octet de plus indique seulement que le fichier continue
+            var probe = new uint8[1];
+            size_t probe_read = 0;
+            if (bytes_read == PREVIEW_MAX_BYTES) {
+                yield stream.read_all_async(probe, Priority.DEFAULT, cancellable, out probe_read);
+            }
+            yield stream.close_async(Priority.DEFAULT, cancellable);
+
+            data[bytes_read] = 0;
+            unowned string text = (string) data;
+            char* end;
+            if (!text.validate((ssize_t) bytes_read, out end)) {
+                size_t valid_length = (size_t) (end - (char*) text);
+                // Seul un caractère coupé en fin de lecture est toléré ; sinon, fichier binaire
+                if (probe_read == 0 || valid_length + 4 < bytes_read) {
+                    return new PreviewResult();
+                }
+                bytes_read = valid_length;
             }
+
+            var result = new PreviewResult();
+            result.kind = PreviewKind.TEXT;
+            result.text = text.substring(0, (long) bytes_read);
+            result.truncated = probe_read > 0;
+            result.cost = bytes_read;
+            return result;
+        }
+
+        /**
+         * Décode une image à la taille d'affichage sur le pool de décodage
+         *
+         * La vignette freedesktop existante est utilisée quand elle suffit.
+         */
+        private async PreviewResult decode_image(string path, string? thumbnail, int target_size, Cancellable cancellable) throws Error {
+            var job = new DecodeJob();
+            job.path = thumbnail != null && target_size <= THUMBNAIL_MAX_SIZE ? thumbnail : path;
+            job.target_size = target_size;
+            job.cancellable = cancellable;
+            job.callback = decode_image.callback;
+
+            if (decode_pool == null) {
+                decode_pool = new ThreadPool<DecodeJob>.with_owned_data((pending) => {
+                    pending.run();
+                }, DECODE_THREADS, false);
+            }
+            decode_pool.add(job);
+            yield;
+
+            cancellable.set_error_if_cancelled();
+            if (job.error != null) {
+                throw job.error;
+            }
+
+            var result = new PreviewResult();
+            result.kind = PreviewKind.IMAGE;
+            result.texture = Gdk.Texture.for_pixbuf(job.pixbuf);
+            result.cost = (size_t) job.pixbuf.get_rowstride() * job.pixbuf.get_height();
+            return result;
         }
 
         /**
          * Efface la prévisualisation
          */
         public void clear() {
+            cancel_pending_load();
             title_label.set_text("");
             info_label.set_text("");
             file_icon.clear();
             buffer.set_text("", 0);
+            image_view.set_paintable(null);
             preview_stack.set_visible_child_name("placeholder");
         }
 
@@ -225,74 +387,12 @@ namespace Sambo {
          * Affiche un aperçu du fichier spécifié
          */
         public void show_preview(FileItemModel file_item) {
-            // Mettre à jour l'en-tête
-            title_label.set_markup("<b>" + GLib.Markup.escape_text(file_item.name) + "</b>");
-
-            string info_text = "";
-            if (!file_item.is_directory()) {
-                info_text = file_item.get_formatted_size() + " - " + file_item.get_formatted_modified_time();
-            } else {
-                info_text = "Dossier - " + file_item.get_formatted_modified_time();
-            }
-
-            info_label.set_label(info_text);
-
-            // Mettre à jour l'icône
-            try {
-                if (file_item.icon != null) {
-                    file_icon.set_from_gicon(file_item.icon);
-                } else if (file_item.is_directory()) {
-                    file_icon.set_from_icon_name("folder");
-                } else {
-                    file_icon.set_from_icon_name("text-x-generic");
-                }
-            } catch (Error e) {
-                warning("Erreur lors de la définition de l'icône: %s", e.message);
-                file_icon.set_from_icon_name("text-x-generic");
-            }
-
-            // Si c'est un dossier, montrer un message spécial
             if (file_item.is_directory()) {
+                cancel_pending_load();
                 set_empty_state("Dossier: " + file_item.name + "\n\nContient des éléments que vous pouvez explorer.");
                 return;
             }
-
-            // Pour les fichiers texte, charger le contenu
-            if (is_previewable_text_file(file_item)) {
-                try {
-                    // Vérifier que le contrôleur est initialisé
-                    if (controller == null) {
-                        set_empty_state("Erreur: Contrôleur non initialisé");
-                        return;
-                    }
-
-                    // Lire le contenu du fichier directement
-                    string content;
-                    try {
-                        FileUtils.get_contents(file_item.path, out content);
-
-                        // Limiter la taille du texte prévisualisé pour les performances
-                        if (content.length > 10000) {
-                            content = content.substring(0, 10000) + "\n\n[...] Le fichier est trop grand pour être affiché en entier.";
-                        }
-                    } catch (Error e) {
-                        set_empty_state("Erreur lors de la lecture du fichier: " + e.message);
-                        return;
-                    }
-
-                    if (content != null) {
-                        buffer.set_text(content, -1);
-                        apply_syntax_highlighting(file_item.get_extension());
-                        preview_stack.set_visible_child_name("text");
-                    } else {
-                        set_empty_state("Impossible de générer un aperçu pour ce fichier.");
-                    }
-                } catch (Error e) {
-                    set_empty_state("Erreur lors du chargement de l'aperçu: " + e.message);
-                }
-            } else {
-                set_empty_state("L'aperçu n'est pas disponible pour ce type de fichier.");
-            }
+            preview_file(file_item);
         }
 
         /**
@@ -329,10 +429,7 @@ namespace Sambo {
             // Cette fonction sera développée dans une phase future
             // Pour l'instant, on peut ajouter une coloration basique
 
-            TextTag keyword_tag = buffer.create_tag("keyword", "foreground", "#0000FF", "weight", Pango.Weight.BOLD);
-            TextTag string_tag = buffer.create_tag("string", "foreground", "#AA2222");
-            TextTag comment_tag = buffer.create_tag("comment", "foreground", "#227722", "style", Pango.Style.ITALIC);
-
+            // Les tags sont créés une seule fois dans le constructeur
             // Exemple simple pour quelques langages courants
             switch (extension.down()) {
                 case "vala":
@@ -371,6 +468,9 @@ namespace Sambo {
 
             foreach (string keyword in keywords) {
                 int pos = 0;
+                // index_of travaille en octets, les TextIter en caractères
+                int last_byte = 0;
+                int last_char = 0;
 
                 while ((pos = content.index_of(keyword, pos)) != -1) {
                     // Vérifier que c'est bien un mot séparé
@@ -379,9 +479,12 @@ namespace Sambo {
                                       !content[pos + keyword.length].isalnum();
 
                     if (is_word_start && is_word_end) {
+                        last_char += ((string) ((char*) content + last_byte)).char_count(pos - last_byte);
+                        last_byte = pos;
+
                         TextIter start, end;
-                        buffer.get_iter_at_offset(out start, pos);
-                        buffer.get_iter_at_offset(out end, pos + keyword.length);
+                        buffer.get_iter_at_offset(out start, last_char);
+                        buffer.get_iter_at_offset(out end, last_char + keyword.char_count());
                         buffer.apply_tag_by_name(tag_name, start, end);
                     }
 
@@ -391,4 +494,102 @@ namespace Sambo {
             }
         }
     }
+
+    private enum PreviewKind {
+        NONE,
+        TEXT,
+        IMAGE
+    }
+
+    /**
+     * Contenu d'aperçu prêt à afficher
+     */
+    private class PreviewResult {
+        public PreviewKind kind = PreviewKind.NONE;
+        public string? text = null;
+        public bool truncated = false;
+        public Gdk.Texture? texture = null;
+        public size_t cost = 0;
+    }
+
+    /**
+     * Décodage d'une image sur le pool, reprise de l'appel async sur le thread principal
+     */
+    private class DecodeJob {
+        public string path;
+        public int target_size;
+        public Cancellable cancellable;
+        public SourceFunc callback;
+        public Gdk.Pixbuf? pixbuf = null;
+        public Error? error = null;
+
+        public void run() {
+            // Sélection déjà changée : inutile de décoder
+            if (!cancellable.is_cancelled()) {
+                try {
+                    // Ne pas agrandir les petites images
+                    int width, height;
+                    if (Gdk.Pixbuf.get_file_info(path, out width, out height) != null &&
+                        width <= target_size && height <= target_size) {
+                        pixbuf = new Gdk.Pixbuf.from_file(path);
+                    } else {
+                        pixbuf = new Gdk.Pixbuf.from_file_at_scale(path, target_size, target_size, true);
+                    }
+                } catch (Error e) {
+                    error = e;
+                }
+            }
+            Idle.add((owned) callback);
+        }
+    }
+
+    /**
+     * Cache LRU des aperçus, partagé par toutes les zones de prévisualisation
+     *
+     * Les clés incluent la date de modification et la taille : un fichier
+     * modifié n'est jamais servi depuis une entrée périmée.
+     */
+    private class PreviewCache {
+        private const size_t MAX_COST = 64 * 1024 * 1024;
+        private const int MAX_ENTRIES = 128;
+
+        private static PreviewCache? instance = null;
+
+        private Gee.LinkedList<string> order = new Gee.LinkedList<string>();
+        private Gee.HashMap<string, PreviewResult> entries = new Gee.HashMap<string, PreviewResult>();
+        private size_t total_cost = 0;
+
+        public static PreviewCache get_default() {
+            if (instance == null) {
+                instance = new PreviewCache();
+            }
+            return instance;
+        }
+
+        public PreviewResult? lookup(string key) {
+            var result = entries[key];
+            if (result != null) {
+                order.remove(key);
+                order.offer_head(key);
+            }
+            return result;
+        }
+
+        public void insert(string key, PreviewResult result) {
+            if (entries.has_key(key)) {
+                return;
+            }
+            entries[key] = result;
+            order.offer_head(key);
+            total_cost += result.cost;
+
+            while ((total_cost > MAX_COST || order.size > MAX_ENTRIES) && order.size > 1) {
+                string oldest = order.poll_tail();
+                PreviewResult evicted;
+                if (entries.unset(oldest, out evicted)) {
+                    total_cost -= evicted.cost;
+                }
+            }
+        }
+    }
 }
@@ -7,6 +7,9 @@ namespace Sambo {
      * Dialogue d'édition des profils d'inférence avec design moderne
      */
     public class ProfileEditorDialog : Adw.Window {
+        private const string[] KV_CACHE_TYPES = { "f16", "q8_0", "q4_0" };
+        private const string[] KV_CACHE_LABELS = { "F16 (pleine précision)", "Q8_0 (moitié de la mémoire)", "Q4_0 (quart de la mémoire)" };
+
         private ApplicationController controller;
         private ConfigManager config_manager;
         private InferenceProfile? original_profile;
@@ -28,6 +31,8 @@ namespace Sambo {
         private DropDown model_dropdown;
         private StringList model_list;
         private HashMap<string, string> model_paths;
+        private Adw.PreferencesGroup lora_group;
+        private ArrayList<Widget> lora_rows = new ArrayList<Widget>();
 
         // Paramètres de sampling avec design moderne
         private Adw.SpinRow temperature_row;
@@ -39,6 +44,9 @@ namespace Sambo {
         private Adw.SpinRow presence_penalty_row;
         private Adw.SpinRow seed_row;
         private Adw.SpinRow context_length_row;
+        private Adw.ComboRow kv_cache_row;
+        private Adw.SwitchRow flash_attention_row;
+        private Adw.ActionRow kv_estimate_row;
         private Adw.SwitchRow stream_row;
 
         public signal void profile_saved(InferenceProfile profile);
@@ -104,6 +112,7 @@ namespace Sambo {
             // Créer les sections avec design moderne
             create_general_section();
             create_model_section();
+            create_lora_section();
             create_prompt_section();
             create_template_section();
             create_sampling_section();
@@ -273,6 +282,88 @@ namespace Sambo {
             preferences_page.add(group);
         }
 
+        private void create_lora_section() {
+            lora_group = new Adw.PreferencesGroup();
+            lora_group.set_title("🧩 Adaptateurs LoRA");
+            lora_group.set_description("Appliqués au modèle de base sans le recharger");
+
+            var add_button = new Button.from_icon_name("list-add-symbolic");
+            add_button.set_tooltip_text("Ajouter un adaptateur");
+            add_button.set_valign(Align.CENTER);
+            add_button.add_css_class("flat");
+            add_button.clicked.connect(on_add_lora_clicked);
+            lora_group.set_header_suffix(add_button);
+
+            refresh_lora_rows();
+            preferences_page.add(lora_group);
+        }
+
+        private void refresh_lora_rows() {
+            foreach (var row in lora_rows) {
+                lora_group.remove(row);
+            }
+            lora_rows.clear();
+
+            if (editing_profile.lora_adapters.size == 0) {
+                var empty_row = new Adw.ActionRow();
+                empty_row.set_title("Aucun adaptateur");
+                empty_row.set_subtitle("Le modèle de base est utilisé tel quel");
+                lora_group.add(empty_row);
+                lora_rows.add(empty_row);
+                return;
+            }
+
+            foreach (var adapter in editing_profile.lora_adapters) {
+                var row = new Adw.SpinRow.with_range(0.0, 2.0, 0.05);
+                row.set_title(Path.get_basename(adapter.path));
+                row.set_subtitle("Échelle");
+                row.set_tooltip_text(adapter.path);
+                row.set_digits(2);
+                row.set_value(adapter.scale);
+                row.notify["value"].connect(() => {
+                    adapter.scale = (float) row.get_value();
+                });
+
+                var remove_button = new Button.from_icon_name("user-trash-symbolic");
+                remove_button.set_tooltip_text("Retirer l'adaptateur");
+                remove_button.set_valign(Align.CENTER);
+                remove_button.add_css_class("flat");
+                remove_button.clicked.connect(() => {
+                    editing_profile.lora_adapters.remove(adapter);
+                    refresh_lora_rows();
+                });
+                row.add_suffix(remove_button);
+
+                lora_group.add(row);
+                lora_rows.add(row);
+            }
+        }
+
+        private void on_add_lora_clicked() {
+            var filter = new FileFilter();
+            filter.set_filter_name("Adaptateurs GGUF");
+            filter.add_pattern("*.gguf");
+            var filters = new GLib.ListStore(typeof(FileFilter));
+            filters.append(filter);
+
+            var file_dialog = new Gtk.FileDialog();
+            file_dialog.set_modal(true);
+            file_dialog.set_title("Choisir un adaptateur LoRA");
+            file_dialog.set_filters(filters);
+
+            file_dialog.open.begin(this, null, (obj, res) => {
+                try {
+                    var file = file_dialog.open.end(res);
+                    if (file != null) {
+                        editing_profile.lora_adapters.add(new LoraAdapter(file.get_path()));
+                        refresh_lora_rows();
+                    }
+                } catch (Error e) {
+                    // Sélection annulée
+                }
+            });
+        }
+
         private void create_prompt_section() {
             var group = new Adw.PreferencesGroup();
             group.set_title("💬 Prompt système");
@@ -510,7 +601,7 @@ namespace Sambo {
             group.add(seed_row);
 
             // Context length
-            context_length_row = new Adw.SpinRow.with_range(512, 8192, 256);
+            context_length_row = new Adw.SpinRow.with_range(512, 32768, 512);
             context_length_row.set_title("Longueur du contexte");
             context_length_row.set_subtitle("Mémoire de l'IA en tokens");
             context_length_row.set_value(editing_profile.context_length);
@@ -519,6 +610,46 @@ namespace Sambo {
             context_length_row.add_prefix(context_icon);
             group.add(context_length_row);
 
+            // Précision du cache KV
+            kv_cache_row = new Adw.ComboRow();
+            kv_cache_row.set_title("Précision du cache KV");
+            kv_cache_row.set_subtitle("Les formats quantifiés permettent des contextes plus longs");
+            kv_cache_row.set_model(new StringList(KV_CACHE_LABELS));
+            kv_cache_row.set_selected(0);
+            for (uint i = 0; i < KV_CACHE_TYPES.length; i++) {
+                if (KV_CACHE_TYPES[i] == editing_profile.kv_cache_type) {
+                    kv_cache_row.set_selected(i);
+                }
+            }
+            var kv_icon = new Image.from_icon_name("drive-harddisk-symbolic");
+            kv_icon.add_css_class("accent");
+            kv_cache_row.add_prefix(kv_icon);
+            group.add(kv_cache_row);
+
+            // Flash attention
+            flash_attention_row = new Adw.SwitchRow();
+            flash_attention_row.set_title("Flash attention");
+            flash_attention_row.set_subtitle("Requise pour quantifier aussi les valeurs du cache");
+            flash_attention_row.set_active(editing_profile.flash_attention);
+            var flash_icon = new Image.from_icon_name("weather-storm-symbolic");
+            flash_icon.add_css_class("warning");
+            flash_attention_row.add_prefix(flash_icon);
+            group.add(flash_attention_row);
+
+            // Empreinte mémoire estimée du cache KV
+            kv_estimate_row = new Adw.ActionRow();
+            kv_estimate_row.set_title("Mémoire du cache KV");
+            var estimate_icon = new Image.from_icon_name("dialog-information-symbolic");
+            estimate_icon.add_css_class("dim-label");
+            kv_estimate_row.add_prefix(estimate_icon);
+            group.add(kv_estimate_row);
+
+            context_length_row.notify["value"].connect(update_kv_estimate);
+            kv_cache_row.notify["selected"].connect(update_kv_estimate);
+            flash_attention_row.notify["active"].connect(update_kv_estimate);
+            model_dropdown.notify["selected"].connect(update_kv_estimate);
+            update_kv_estimate();
+
             // Stream avec icône animée
             stream_row = new Adw.SwitchRow();
             stream_row.set_title("Mode streaming");
@@ -532,6 +663,34 @@ namespace Sambo {
             preferences_page.add(group);
         }
 
+        private void update_kv_estimate() {
+            string model_path = get_selected_model_path();
+            if (model_path == "") {
+                kv_estimate_row.set_subtitle("Sélectionnez un modèle pour estimer");
+                return;
+            }
+
+            uint kv_index = kv_cache_row.get_selected();
+            string kv_type = kv_index < KV_CACHE_TYPES.length ? KV_CACHE_TYPES[kv_index] : "f16";
+            int64 bytes = Llama.estimate_kv_cache_size(model_path, (int) context_length_row.get_value(),
+                                                       InferenceProfile.parse_kv_cache_type(kv_type),
+                                                       flash_attention_row.get_active());
+            if (bytes < 0) {
+                kv_estimate_row.set_subtitle("Estimation indisponible pour ce modèle");
+            } else {
+                kv_estimate_row.set_subtitle("≈ %s en plus des poids du modèle".printf(format_size((uint64) bytes)));
+            }
+        }
+
+        private string get_selected_model_path() {
+            var selected_model = model_dropdown.get_selected();
+            if (selected_model > 0 && selected_model != Gtk.INVALID_LIST_POSITION) {
+                var selected_text = model_list.get_string(selected_model);
+                return model_paths.get(selected_text) ?? "";
+            }
+            return "";
+        }
+
         private void populate_model_list() {
             model_list.splice(0, model_list.get_n_items(), null);
             model_paths.clear();
@@ -655,13 +814,7 @@ Tu es un assistant de recherche rigoureux. Fournis des informations factuelles e
             editing_profile.template = template_textview.get_buffer().get_text(start, end, false).strip();
 
             // Récupérer le modèle sélectionné
-            var selected_model = model_dropdown.get_selected();
-            if (selected_model > 0) {
-                var selected_text = model_list.get_string(selected_model);
-                editing_profile.model_path = model_paths.get(selected_text) ?? "";
-            } else {
-                editing_profile.model_path = "";
-            }
+            editing_profile.model_path = get_selected_model_path();
 
             // Paramètres de sampling
             editing_profile.temperature = (float)temperature_row.get_value();
@@ -674,6 +827,9 @@ Tu es un assistant de recherche rigoureux. Fournis des informations factuelles e
             editing_profile.seed = (int)seed_row.get_value();
             editing_profile.context_length = (int)context_length_row.get_value();
             editing_profile.stream = stream_row.get_active();
+            uint kv_index = kv_cache_row.get_selected();
+            editing_profile.kv_cache_type = kv_index < KV_CACHE_TYPES.length ? KV_CACHE_TYPES[kv_index] : "f16";
+            editing_profile.flash_attention = flash_attention_row.get_active();
 
             // Validation finale
             var errors = editing_profile.get_validation_errors();
@@ -514,6 +514,7 @@ namespace Sambo {
             add_parameter_row(advanced_group, "Pénalité présence", profile.presence_penalty.to_string("%.2f"), "Encourage la nouveauté", "warning");
             add_parameter_row(advanced_group, "Graine (seed)", profile.seed == -1 ? "🎲 Aléatoire" : profile.seed.to_string(), "Reproductibilité", "accent");
             add_parameter_row(advanced_group, "Contexte", profile.context_length.to_string() + " tokens", "Taille du contexte", "accent");
+            add_parameter_row(advanced_group, "Cache KV", profile.kv_cache_type.up() + (profile.flash_attention ? " · flash attention" : ""), "Précision du cache", "accent");
 
             var stream_row = new Adw.ActionRow();
             stream_row.set_title("Mode streaming");
@@ -15,11 +15,30 @@ namespace Sambo {
         private TextView terminal_view;
         private TextBuffer buffer;
         private string current_command = "";
-        private int command_start_offset = 0;
+        // Début de la saisie courante, suit le texte lors de la purge de l'historique
+        private TextMark command_start_mark;
+        // Vrai pendant les modifications faites par la vue elle-même (sortie, purge)
+        private bool internal_edit = false;
+
+        // Exécution réelle des commandes
+        private TerminalSession session;
+        // Sortie reçue depuis la dernière image, insérée en une fois
+        private StringBuilder pending_output = new StringBuilder();
+        private int pending_lines = 0;
+        private size_t dropped_output_bytes = 0;
+        private uint flush_tick_id = 0;
 
         // Le prompt qui sera affiché
         private const string PROMPT = "sambo> ";
 
+        // Historique limité : au-delà de MAX_SCROLLBACK_LINES + TRIM_SLACK_LINES,
+        // ou de MAX_SCROLLBACK_CHARS + TRIM_SLACK_CHARS pour une sortie sans
+        // retour à la ligne, le début est supprimé en un seul bloc
+        private const int MAX_SCROLLBACK_LINES = 5000;
+        private const int TRIM_SLACK_LINES = 500;
+        private const int MAX_SCROLLBACK_CHARS = 1024 * 1024;
+        private const int TRIM_SLACK_CHARS = 128 * 1024;
+
         /**
          * Crée une nouvelle vue de terminal
          */
@@ -40,6 +59,18 @@ namespace Sambo {
 
             buffer = terminal_view.get_buffer();
 
+            buffer.create_tag("prompt", "foreground", "#4ec9b0", "weight", Pango.Weight.BOLD);
+            buffer.create_tag("output", "foreground", "#dcdcaa");
+            buffer.create_tag("error", "foreground", "#f14c4c");
+
+            TextIter start_iter;
+            buffer.get_start_iter(out start_iter);
+            command_start_mark = buffer.create_mark("command-start", start_iter, true);
+
+            session = new TerminalSession();
+            session.output_received.connect(queue_output);
+            session.command_finished.connect(on_process_finished);
+
             // Créer un style pour le texte du terminal
             var css_provider = new CssProvider();
             try {
@@ -98,6 +129,15 @@ namespace Sambo {
             // Afficher le message d'accueil
             print_welcome_message();
 
+            // Ne pas laisser de processus orphelin à la fermeture
+            this.destroy.connect(() => {
+                session.terminate();
+                if (flush_tick_id != 0) {
+                    remove_tick_callback(flush_tick_id);
+                    flush_tick_id = 0;
+                }
+            });
+
             // S'abonner au signal d'exécution de commande
             controller.subscribe_to_terminal_commands(on_command_executed);
 
@@ -142,9 +182,11 @@ namespace Sambo {
             TextIter end_iter;
             buffer.get_end_iter(out end_iter);
 
-            buffer.insert_markup(ref end_iter,
-                "<span foreground='#4ec9b0'>Sambo Terminal v0.1.0</span>\n" +
-                "<span foreground='#dcdcaa'>Tapez 'help' pour voir les commandes disponibles.</span>\n\n", -1);
+            internal_edit = true;
+            buffer.insert_with_tags_by_name(ref end_iter, "Sambo Terminal v0.1.0\n", -1, "prompt");
+            buffer.insert_with_tags_by_name(ref end_iter,
+                "Tapez 'help' pour voir les commandes internes ; toute autre commande est exécutée par le shell.\n\n", -1, "output");
+            internal_edit = false;
 
             show_prompt();
         }
@@ -156,11 +198,13 @@ namespace Sambo {
             TextIter end_iter;
             buffer.get_end_iter(out end_iter);
 
-            buffer.insert_markup(ref end_iter, "<span foreground='#4ec9b0'>" + PROMPT + "</span>", -1);
+            internal_edit = true;
+            buffer.insert_with_tags_by_name(ref end_iter, get_prompt_text(), -1, "prompt");
+            internal_edit = false;
 
             // Mémoriser la position de début de commande
             buffer.get_end_iter(out end_iter);
-            command_start_offset = end_iter.get_offset();
+            buffer.move_mark(command_start_mark, end_iter);
 
             // Réinitialiser la commande courante
             current_command = "";
@@ -173,20 +217,42 @@ namespace Sambo {
          * Gère les événements clavier pour contrôler la saisie
          */
         private bool on_key_press(Gtk.EventControllerKey controller, uint keyval, uint keycode, Gdk.ModifierType state) {
+            // Ctrl+C interrompt la commande en cours
+            if (session.is_running() && (state & Gdk.ModifierType.CONTROL_MASK) != 0 &&
+                (keyval == Gdk.Key.c || keyval == Gdk.Key.C)) {
+                session.interrupt();
+                return true;
+            }
+
+            // Ctrl+D ferme l'entrée standard de la commande en cours (fin de fichier)
+            if (session.is_running() && (state & Gdk.ModifierType.CONTROL_MASK) != 0 &&
+                (keyval == Gdk.Key.d || keyval == Gdk.Key.D)) {
+                session.close_input();
+                return true;
+            }
+
             // Gérer la touche Entrée pour exécuter la commande
             if (keyval == Gdk.Key.Return || keyval == Gdk.Key.KP_Enter) {
                 TextIter start, end;
-                buffer.get_iter_at_offset(out start, command_start_offset);
+                buffer.get_iter_at_mark(out start, command_start_mark);
                 buffer.get_end_iter(out end);
 
                 string command = buffer.get_text(start, end, false);
                 current_command = command;
 
                 // Ajouter un saut de ligne
+                internal_edit = true;
                 buffer.insert(ref end, "\n", 1);
+                internal_edit = false;
+                buffer.get_end_iter(out end);
+                buffer.move_mark(command_start_mark, end);
 
-                // Exécuter la commande
-                execute_command(command);
+                if (session.is_running()) {
+                    // Saisie destinée à la commande en cours
+                    session.send_input(command);
+                } else {
+                    execute_command(command);
+                }
 
                 return true;
             }
@@ -198,8 +264,12 @@ namespace Sambo {
          * Filtre l'insertion de texte pour ne permettre que la saisie après le prompt
          */
         private void on_insert_text(TextIter location, string text, int len) {
+            if (internal_edit) return;
+
             // Bloquer l'insertion si c'est avant la position de début de commande
-            if (location.get_offset() < command_start_offset) {
+            TextIter command_start;
+            buffer.get_iter_at_mark(out command_start, command_start_mark);
+            if (location.compare(command_start) < 0) {
                 GLib.Signal.stop_emission_by_name(buffer, "insert-text");
 
                 // Insérer le texte à la fin à la place
@@ -213,8 +283,12 @@ namespace Sambo {
          * Filtre la suppression de texte pour empêcher la suppression du prompt
          */
         private void on_delete_range(TextIter start, TextIter end) {
+            if (internal_edit) return;
+
             // Si on essaie de supprimer avant le début de commande, bloquer
-            if (start.get_offset() < command_start_offset) {
+            TextIter command_start;
+            buffer.get_iter_at_mark(out command_start, command_start_mark);
+            if (start.compare(command_start) < 0) {
                 GLib.Signal.stop_emission_by_name(buffer, "delete-range");
             }
         }
@@ -223,8 +297,10 @@ namespace Sambo {
          * Détecte les changements dans le buffer et met à jour la commande courante
          */
         private void on_buffer_changed() {
+            if (internal_edit) return;
+
             TextIter start, end;
-            buffer.get_iter_at_offset(out start, command_start_offset);
+            buffer.get_iter_at_mark(out start, command_start_mark);
             buffer.get_end_iter(out end);
 
             current_command = buffer.get_text(start, end, false);
@@ -236,7 +312,9 @@ namespace Sambo {
         private void display_response_and_scroll(string response) {
             TextIter end;
             buffer.get_end_iter(out end);
-            buffer.insert_markup(ref end, "<span foreground='#dcdcaa'>" + response + "</span>\n", -1);
+            internal_edit = true;
+            buffer.insert_with_tags_by_name(ref end, response + "\n", -1, "output");
+            internal_edit = false;
 
             // Afficher le prompt pour une nouvelle commande
             show_prompt();
@@ -274,72 +352,240 @@ namespace Sambo {
 
         /**
          * Exécute une commande entrée dans le terminal
+         *
+         * Quelques commandes internes sont traitées directement ; les autres
+         * sont lancées par le shell et leur sortie s'affiche au fil de l'eau.
          */
         private void execute_command(string command) {
-            if (command == "")
+            string trimmed = command.strip();
+            if (trimmed == "") {
+                show_prompt();
                 return;
+            }
 
             string response = "";
 
-            // Commandes simples pour tester
-            switch (command) {
-                case "hello":
-                    response = "Hello World!";
-                    break;
-
+            switch (trimmed) {
                 case "help":
-                    response = "Commandes disponibles:\n" +
-                              "  hello   - Affiche Hello World\n" +
+                    response = "Commandes internes:\n" +
                               "  help    - Affiche cette aide\n" +
                               "  clear   - Efface le terminal\n" +
-                              "  date    - Affiche la date et l'heure actuelles\n" +
-                              "  version - Affiche la version de l'application";
+                              "  cd DIR  - Change le répertoire courant\n" +
+                              "  version - Affiche la version de l'application\n" +
+                              "Toute autre commande est exécutée par /bin/sh (Ctrl+C pour l'interrompre,\n" +
+                              "Ctrl+D pour terminer son entrée).";
                     break;
 
                 case "clear":
+                    internal_edit = true;
                     buffer.set_text("", -1);
+                    internal_edit = false;
                     show_prompt();
                     scroll_to_bottom();
                     return;
 
-                case "date":
-                    var now = new DateTime.now_local();
-                    response = now.format("%c");
-                    break;
-
                 case "version":
                     response = "Sambo v0.1.0";
                     break;
 
                 default:
-                    response = "Commande inconnue: " + command;
-                    break;
+                    if (trimmed == "cd" || trimmed.has_prefix("cd ")) {
+                        string? error = session.change_directory(trimmed.substring(2));
+                        if (error != null) {
+                            append_tagged(error + "\n", "error");
+                        }
+                        show_prompt();
+                        return;
+                    }
+
+                    session.run(command);
+                    return;
             }
 
             // Utiliser la nouvelle méthode pour afficher la réponse et défiler
             display_response_and_scroll(response);
         }
 
+        /**
+         * Prompt affiché, avec le nom du répertoire courant
+         */
+        private string get_prompt_text() {
+            return "%s %s".printf(Path.get_basename(session.working_directory), PROMPT);
+        }
+
+        /**
+         * Met en attente la sortie du processus jusqu'à la prochaine image
+         *
+         * Une commande bavarde produit des milliers de lectures par seconde :
+         * une seule insertion par image évite de relancer la mise en page du
+         * TextView à chaque morceau. Ce qui dépasserait de toute façon
+         * l'historique est écarté avant l'insertion.
+         */
+        private void queue_output(string text) {
+            pending_output.append(text);
+            for (int i = 0; i < text.length; i++) {
+                if (text[i] == '\n') {
+                    pending_lines++;
+                }
+            }
+            if (pending_lines > MAX_SCROLLBACK_LINES + TRIM_SLACK_LINES ||
+                pending_output.len > MAX_SCROLLBACK_CHARS + TRIM_SLACK_CHARS) {
+                trim_pending_output();
+            }
+
+            if (flush_tick_id == 0) {
+                flush_tick_id = add_tick_callback((widget, clock) => {
+                    flush_tick_id = 0;
+                    flush_output();
+                    return Source.REMOVE;
+                });
+            }
+        }
+
+        /**
+         * Ne garde que la fin de la sortie en attente : MAX_SCROLLBACK_LINES
+         * lignes et MAX_SCROLLBACK_CHARS octets au plus
+         */
+        private void trim_pending_output() {
+            unowned string text = pending_output.str;
+            ssize_t min_start = pending_output.len - MAX_SCROLLBACK_CHARS;
+            ssize_t start = pending_output.len;
+            int lines = 0;
+            while (start > 0 && start > min_start) {
+                if (text[start - 1] == '\n') {
+                    if (lines == MAX_SCROLLBACK_LINES) {
+                        break;
+                    }
+                    lines++;
+                }
+                start--;
+            }
+            // Ne pas couper un caractère UTF-8 en deux
+            while (start < pending_output.len && (((uchar) text[start]) & 0xC0) == 0x80) {
+                start++;
+            }
+
+            dropped_output_bytes += start;
+            pending_output.erase(0, start);
+            pending_lines = lines;
+        }
+
+        private void flush_output() {
+            if (pending_output.len == 0) {
+                return;
+            }
+            if (dropped_output_bytes > 0) {
+                append_tagged("[%s de sortie omis]\n".printf(format_size((uint64) dropped_output_bytes)), "error");
+                dropped_output_bytes = 0;
+            }
+            append_tagged(pending_output.str, "output");
+            pending_output.truncate(0);
+            pending_lines = 0;
+
+            // La saisie pendant l'exécution commence après la dernière sortie
+            TextIter end;
+            buffer.get_end_iter(out end);
+            buffer.move_mark(command_start_mark, end);
+
+            trim_scrollback();
+            scroll_to_end_now();
+        }
+
+        private void on_process_finished(int exit_status) {
+            if (flush_tick_id != 0) {
+                remove_tick_callback(flush_tick_id);
+                flush_tick_id = 0;
+            }
+            flush_output();
+
+            TextIter end;
+            buffer.get_end_iter(out end);
+            if (end.get_line_offset() != 0) {
+                append_tagged("\n", "output");
+            }
+            if (exit_status != 0) {
+                append_tagged("[code de sortie %d]\n".printf(exit_status), "error");
+            }
+            show_prompt();
+        }
+
+        private void append_tagged(string text, string tag_name) {
+            TextIter end;
+            buffer.get_end_iter(out end);
+            internal_edit = true;
+            buffer.insert_with_tags_by_name(ref end, text, -1, tag_name);
+            internal_edit = false;
+        }
+
+        /**
+         * Supprime en un seul bloc le texte le plus ancien au-delà des limites
+         * en lignes et en caractères
+         */
+        private void trim_scrollback() {
+            int line_count = buffer.get_line_count();
+            int char_count = buffer.get_char_count();
+            bool too_many_lines = line_count > MAX_SCROLLBACK_LINES + TRIM_SLACK_LINES;
+            bool too_many_chars = char_count > MAX_SCROLLBACK_CHARS + TRIM_SLACK_CHARS;
+            if (!too_many_lines && !too_many_chars) {
+                return;
+            }
+
+            TextIter start, cut;
+            buffer.get_start_iter(out start);
+            cut = start;
+            if (too_many_lines) {
+                buffer.get_iter_at_line(out cut, line_count - MAX_SCROLLBACK_LINES);
+            }
+            if (too_many_chars) {
+                TextIter char_cut;
+                buffer.get_iter_at_offset(out char_cut, char_count - MAX_SCROLLBACK_CHARS);
+                if (char_cut.compare(cut) > 0) {
+                    cut = char_cut;
+                }
+            }
+            internal_edit = true;
+            buffer.delete(ref start, ref cut);
+            internal_edit = false;
+        }
+
+        /**
+         * Défilement immédiat vers le bas, sans les relances de scroll_to_bottom
+         */
+        private void scroll_to_end_now() {
+            TextIter end;
+            buffer.get_end_iter(out end);
+            buffer.place_cursor(end);
+            terminal_view.scroll_mark_onscreen(buffer.get_insert());
+        }
+
+        /**
+         * Contenu affiché du terminal (historique conservé), en texte brut
+         */
+        public string get_transcript() {
+            TextIter start, end;
+            buffer.get_bounds(out start, out end);
+            return buffer.get_text(start, end, false);
+        }
+
         /**
          * Appelée quand une commande est exécutée via le contrôleur
          */
         private void on_command_executed(string command, string output) {
             if (output == "CLEAR_TERMINAL") {
+                internal_edit = true;
                 buffer.set_text("", -1);
+                internal_edit = false;
                 print_welcome_message();
                 scroll_to_bottom();
                 return;
             }
 
             // Afficher la commande
-            TextIter end;
-            buffer.get_end_iter(out end);
-            buffer.insert(ref end, command + "\n", -1);
+            append_tagged(command + "\n", "output");
 
             // Afficher le résultat
             if (output != "") {
-                buffer.get_end_iter(out end);
-                buffer.insert_markup(ref end, "<span foreground='#dcdcaa'>" + output + "</span>\n", -1);
+                append_tagged(output + "\n", "output");
             }
 
             // Afficher un nouveau prompt
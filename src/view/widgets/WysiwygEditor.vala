@@ -20,6 +20,19 @@ namespace Sambo {
 
         private Gtk.CssProvider css_provider;
 
+        // Correspondance incrémentale buffer <-> nœuds du document
+        private const uint SYNC_DELAY_MS = 300;
+        private Gee.ArrayList<NodeSpan> spans = new Gee.ArrayList<NodeSpan>();
+        private Gee.HashMap<PivotNode, NodeSpan> node_spans = new Gee.HashMap<PivotNode, NodeSpan>();
+        private bool has_dirty_spans = false;
+        private bool loading = false;
+        private uint sync_timeout_id = 0;
+
+        // Affichage progressif des documents longs
+        private const int INITIAL_RENDER_NODES = 150;
+        private const int RENDER_BATCH_NODES = 200;
+        private uint render_idle_id = 0;
+
         public signal void document_changed(PivotDocument doc);
         public signal void buffer_changed();
 
@@ -65,8 +78,17 @@ namespace Sambo {
             tag_list = buffer.create_tag("list", "left-margin", 20);
 
             buffer.changed.connect(() => {
-                buffer_changed();
+                // L'affichage progressif d'un document n'est pas une modification
+                if (!loading) {
+                    buffer_changed();
+                }
             });
+
+            // Suivi des plages modifiées (avant application par le buffer)
+            buffer.insert_text.connect(on_insert_text);
+            buffer.delete_range.connect(on_delete_range);
+            buffer.apply_tag.connect(on_tag_changed);
+            buffer.remove_tag.connect(on_tag_changed);
         }
 
         // Exemple d'utilisation sécurisée d'un tag
@@ -331,362 +353,578 @@ namespace Sambo {
             stderr.printf("🔍 WysiwygEditor.load_pivot_document: FIN\n");
         }
 
+        /**
+         * Affiche le document par lots
+         *
+         * Les premiers nœuds sont affichés tout de suite ; les suivants sont
+         * ajoutés en fin de buffer par une source de basse priorité. Avec un
+         * document binaire paresseux, chaque nœud n'est donc décodé qu'au
+         * moment de son affichage et l'ouverture ne paie que le premier lot.
+         * L'historique d'annulation n'est activé qu'une fois le dernier lot
+         * affiché, pour que ces insertions n'y figurent pas.
+         */
         private void render_pivot_to_buffer(PivotDocument doc) {
-            stderr.printf("🔍 WysiwygEditor.render_pivot_to_buffer: DÉBUT\n");
-            stderr.printf("🔍 WysiwygEditor.render_pivot_to_buffer: Widget visible: %s, parent: %s\n",
-                this.get_visible() ? "OUI" : "NON",
-                this.get_parent() != null ? "OUI" : "NON");
+            int64 start_time = get_monotonic_time();
 
-            buffer.set_text("", 0); // Vider le buffer
+            cancel_pending_sync();
+            cancel_pending_render();
+            clear_spans();
 
-            stderr.printf("🔍 WysiwygEditor.render_pivot_to_buffer: APRÈS buffer.set_text - Widget visible: %s\n",
-                this.get_visible() ? "OUI" : "NON");
+            // Désactiver l'historique vide aussi celui du document précédent
+            buffer.enable_undo = false;
+            loading = true;
+            buffer.set_text("", 0);
+            loading = false;
 
-            stderr.printf("🔍 Buffer vidé - Enfants: %d\n",
-                doc != null && doc.children != null ? doc.children.size : 0);
+            int total = doc != null ? doc.children.size : 0;
+            int tag_run_count = append_nodes(doc, int.min(total, INITIAL_RENDER_NODES));
 
-            if (doc == null || doc.children.size == 0) {
-                stderr.printf("🔍 Document null ou sans enfants, sortie\n");
-                return; // Document vide
+            stderr.printf("[PERF] WYSIWYG: %d/%d nœuds affichés, %d plages de tags (%.1f ms)\n",
+                spans.size, total, tag_run_count, (get_monotonic_time() - start_time) / 1000.0);
+
+            if (spans.size >= total) {
+                buffer.enable_undo = true;
+                return;
             }
 
-            TextIter iter;
-            buffer.get_start_iter(out iter);
-
-            foreach (PivotNode node in doc.children) {
-                if (node is PivotHeading) {
-                    var heading = (PivotHeading)node;
-
-                    // Créer une marque pour le début du texte
-                    TextMark start_mark = buffer.create_mark(null, iter, true);
-
-                    // Insérer le texte
-                    buffer.insert(ref iter, heading.text + "\n\n", -1);
-
-                    // Obtenir de nouveaux itérateurs valides à partir des marques
-                    TextIter start, end;
-                    buffer.get_iter_at_mark(out start, start_mark);
-                    end = start;
-                    end.forward_chars(heading.text.length);
-
-                    // Appliquer le tag approprié
-                    if (heading.level == 1) {
-                        buffer.apply_tag(tag_heading1, start, end);
-                    } else if (heading.level == 2) {
-                        buffer.apply_tag(tag_heading2, start, end);
-                    } else if (heading.level >= 3) {
-                        buffer.apply_tag(tag_heading3, start, end);
+            render_idle_id = Idle.add(() => {
+                if (pivot_doc == doc && spans.size < doc.children.size) {
+                    append_nodes(doc, RENDER_BATCH_NODES);
+                    if (spans.size < doc.children.size) {
+                        return Source.CONTINUE;
                     }
+                    stderr.printf("[PERF] WYSIWYG: %d nœuds affichés au total (%.1f ms)\n",
+                        spans.size, (get_monotonic_time() - start_time) / 1000.0);
+                }
+                render_idle_id = 0;
+                buffer.enable_undo = true;
+                return Source.REMOVE;
+            }, Priority.LOW);
+        }
 
-                    // Supprimer la marque qui n'est plus nécessaire
-                    buffer.delete_mark(start_mark);
-                }
-                else if (node is PivotParagraph) {
-                    var para = (PivotParagraph)node;
-
-                    // Marque pour le début du paragraphe
-                    TextMark para_start = buffer.create_mark(null, iter, true);
-
-                    // Pour chaque segment, appliquer le style approprié
-                    foreach (var segment in para.segments) {
-                        TextMark segment_start = buffer.create_mark(null, iter, true);
-                        buffer.insert(ref iter, segment.text, -1);
-                        TextIter seg_start, seg_end;
-                        buffer.get_iter_at_mark(out seg_start, segment_start);
-                        seg_end = iter;
-
-                        // Appliquer tous les styles présents
-                        if (segment.has_format(TextFormatting.BOLD))
-                            buffer.apply_tag(tag_bold, seg_start, seg_end);
-                        if (segment.has_format(TextFormatting.ITALIC))
-                            buffer.apply_tag(tag_italic, seg_start, seg_end);
-                        if (segment.has_format(TextFormatting.STRIKETHROUGH)) {
-                            if (tag_strikethrough == null)
-                                tag_strikethrough = buffer.create_tag("strikethrough", "strikethrough", true);
-                            buffer.apply_tag(tag_strikethrough, seg_start, seg_end);
-                        }
-                        if (segment.has_format(TextFormatting.UNDERLINE)) {
-                            if (tag_underline != null)
-                                buffer.apply_tag(tag_underline, seg_start, seg_end);
-                        }
-                        if (segment.has_format(TextFormatting.CODE))
-                            buffer.apply_tag(tag_code, seg_start, seg_end);
-
-                        buffer.delete_mark(segment_start);
-                    }
+        private void cancel_pending_render() {
+            if (render_idle_id != 0) {
+                Source.remove(render_idle_id);
+                render_idle_id = 0;
+                buffer.enable_undo = true;
+            }
+        }
 
-                    // Ajouter deux sauts de ligne après le paragraphe
-                    buffer.insert(ref iter, "\n\n", -1);
+        /**
+         * Ajoute en fin de buffer les count nœuds suivant ceux déjà affichés
+         *
+         * Les nœuds affichés forment toujours un préfixe du document : le
+         * prochain à afficher est celui d'indice spans.size. Le texte du lot
+         * est inséré d'un bloc, puis les tags sont appliqués par plages fusionnées.
+         * @return Le nombre de plages de tags appliquées
+         */
+        private int append_nodes(PivotDocument? doc, int count) {
+            if (doc == null || count <= 0) {
+                return 0;
+            }
+            int first = spans.size;
+            int stop = int.min(first + count, doc.children.size);
+            if (first >= stop) {
+                return 0;
+            }
 
-                    // Supprimer la marque du paragraphe
-                    buffer.delete_mark(para_start);
-                }
-                else if (node is PivotList) {
-                    var list = (PivotList)node;
-                    foreach (var item in list.items) {
-                        // Insérer l'élément de liste avec un symbole ou un numéro
-                        buffer.insert(ref iter, "• " + item.text + "\n", -1);
-                    }
-                    buffer.insert(ref iter, "\n", -1);
+            TextIter start, end;
+            buffer.get_end_iter(out end);
+            int base_offset = end.get_offset();
+
+            var builder = new StringBuilder();
+            var tag_runs = new Gee.ArrayList<TagRun>();
+            var open_runs = new Gee.HashMap<TextTag, TagRun>();
+            var node_offsets = new Gee.ArrayList<int>();
+            int offset = base_offset;
+
+            // Garder la ligne vide qui sépare les blocs si l'utilisateur a modifié la fin
+            if (base_offset > 0) {
+                buffer.get_iter_at_offset(out start, int.max(0, base_offset - 2));
+                string tail = buffer.get_text(start, end, true);
+                if (!tail.has_suffix("\n\n")) {
+                    append_text(builder, ref offset, tail.has_suffix("\n") ? "\n" : "\n\n");
                 }
-                else if (node is PivotCodeBlock) {
-                    var code = (PivotCodeBlock)node;
+            }
 
-                    // Insérer une ligne vide avant si nécessaire
-                    if (!iter.starts_line() && iter.get_line() > 0) {
-                        buffer.insert(ref iter, "\n", -1);
-                    }
+            for (int i = first; i < stop; i++) {
+                node_offsets.add(offset);
+                append_node_text(doc.children[i], builder, ref offset, tag_runs, open_runs);
+            }
 
-                    // Marque pour le début du bloc de code
-                    TextMark code_start = buffer.create_mark(null, iter, true);
+            bool was_modified = buffer.get_modified();
+            loading = true;
+            buffer.insert(ref end, builder.str, (int) builder.len);
 
-                    // Insérer une indication de langage si disponible
-                    if (code.language != null && code.language != "") {
-                        buffer.insert(ref iter, "[" + code.language + "]\n", -1);
-                    }
+            foreach (var run in tag_runs) {
+                buffer.get_iter_at_offset(out start, run.start);
+                buffer.get_iter_at_offset(out end, run.end);
+                buffer.apply_tag(run.tag, start, end);
+            }
 
-                    // Insérer le code avec préservation des sauts de ligne
-                    buffer.insert(ref iter, code.code, -1);
+            for (int i = first; i < stop; i++) {
+                buffer.get_iter_at_offset(out start, node_offsets[i - first]);
+                add_span(i, doc.children[i], start);
+            }
+            buffer.set_modified(was_modified);
+            loading = false;
 
-                    // Ajouter un saut de ligne après le code
-                    if (!iter.ends_line()) {
-                        buffer.insert(ref iter, "\n", -1);
-                    }
-                    buffer.insert(ref iter, "\n", -1);
+            return tag_runs.size;
+        }
 
-                    // Récupérer un itérateur valide pour le début
-                    TextIter start;
-                    buffer.get_iter_at_mark(out start, code_start);
+        /**
+         * Ajoute le texte d'un nœud au tampon de chargement et note ses plages de tags
+         */
+        private void append_node_text(PivotNode node, StringBuilder builder, ref int offset,
+                                      Gee.List<TagRun> tag_runs, Gee.Map<TextTag, TagRun> open_runs) {
+            if (node is PivotHeading) {
+                var heading = (PivotHeading)node;
+                int text_start = offset;
+                append_text(builder, ref offset, heading.text);
+
+                if (heading.level == 1) {
+                    add_tag_run(tag_runs, open_runs, tag_heading1, text_start, offset);
+                } else if (heading.level == 2) {
+                    add_tag_run(tag_runs, open_runs, tag_heading2, text_start, offset);
+                } else if (heading.level >= 3) {
+                    add_tag_run(tag_runs, open_runs, tag_heading3, text_start, offset);
+                }
+                append_text(builder, ref offset, "\n\n");
+            }
+            else if (node is PivotParagraph) {
+                var para = (PivotParagraph)node;
+                foreach (var segment in para.segments) {
+                    int seg_start = offset;
+                    append_text(builder, ref offset, segment.text);
+
+                    // Appliquer tous les styles présents
+                    if (segment.has_format(TextFormatting.BOLD))
+                        add_tag_run(tag_runs, open_runs, tag_bold, seg_start, offset);
+                    if (segment.has_format(TextFormatting.ITALIC))
+                        add_tag_run(tag_runs, open_runs, tag_italic, seg_start, offset);
+                    if (segment.has_format(TextFormatting.STRIKETHROUGH))
+                        add_tag_run(tag_runs, open_runs, tag_strikethrough, seg_start, offset);
+                    if (segment.has_format(TextFormatting.UNDERLINE))
+                        add_tag_run(tag_runs, open_runs, tag_underline, seg_start, offset);
+                    if (segment.has_format(TextFormatting.CODE))
+                        add_tag_run(tag_runs, open_runs, tag_code, seg_start, offset);
+                }
 
-                    // Appliquer le formatage au bloc de code
-                    buffer.apply_tag(tag_code, start, iter);
+                // Ajouter deux sauts de ligne après le paragraphe
+                append_text(builder, ref offset, "\n\n");
+            }
+            else if (node is PivotList) {
+                var list = (PivotList)node;
+                foreach (var item in list.items) {
+                    // Insérer l'élément de liste avec un symbole ou un numéro
+                    append_text(builder, ref offset, "• " + item.text + "\n");
+                }
+                append_text(builder, ref offset, "\n");
+            }
+            else if (node is PivotCodeBlock) {
+                var code = (PivotCodeBlock)node;
+                int code_start = offset;
 
-                    // Supprimer la marque
-                    buffer.delete_mark(code_start);
+                // Insérer une indication de langage si disponible
+                if (code.language != null && code.language != "") {
+                    append_text(builder, ref offset, "[" + code.language + "]\n");
                 }
-                else if (node is PivotQuote) {
-                    var quote = (PivotQuote)node;
 
-                    // Insérer une ligne vide avant si nécessaire
-                    if (!iter.starts_line() && iter.get_line() > 0) {
-                        buffer.insert(ref iter, "\n", -1);
-                    }
+                // Insérer le code avec préservation des sauts de ligne
+                append_text(builder, ref offset, code.code);
+                if (!code.code.has_suffix("\n")) {
+                    append_text(builder, ref offset, "\n");
+                }
+                append_text(builder, ref offset, "\n");
 
-                    // Marque pour le début de la citation
-                    TextMark quote_start = buffer.create_mark(null, iter, true);
+                add_tag_run(tag_runs, open_runs, tag_code, code_start, offset);
+            }
+            else if (node is PivotQuote) {
+                var quote = (PivotQuote)node;
+                int quote_start = offset;
+
+                // Insérer la citation (avec préfixe visuel)
+                append_text(builder, ref offset, "❝ " + quote.text);
+                if (!quote.text.has_suffix("\n")) {
+                    append_text(builder, ref offset, "\n");
+                }
+                append_text(builder, ref offset, "\n");
 
-                    // Insérer la citation (avec préfixe visuel)
-                    buffer.insert(ref iter, "❝ " + quote.text, -1);
+                add_tag_run(tag_runs, open_runs, tag_quote, quote_start, offset);
+            }
+            else if (node is PivotTable) {
+                var table = (PivotTable)node;
+                append_text(builder, ref offset, "\n--- TABLEAU ---\n");
+
+                // Déterminer le nombre de colonnes (à partir de la première ligne si elle existe)
+                int num_cols = 0;
+                if (table.rows.size > 0 && table.rows[0] != null) {
+                    num_cols = table.rows[0].size;
+                }
 
-                    // Ajouter un saut de ligne après la citation
-                    if (!iter.ends_line()) {
-                        buffer.insert(ref iter, "\n", -1);
+                // En-têtes (simplifié)
+                string header_row = "|";
+                string separator_row = "|";
+                for (int j = 0; j < num_cols; j++) {
+                    header_row += " Col %d |".printf(j + 1);
+                    separator_row += " ----- |";
+                }
+                append_text(builder, ref offset, header_row + "\n");
+                append_text(builder, ref offset, separator_row + "\n");
+
+                // Données
+                foreach (var row in table.rows) {
+                    string data_row = "|";
+                    if (row != null) {
+                        for (int j = 0; j < num_cols; j++) {
+                            // Accéder à la cellule en vérifiant les limites
+                            string? cell_text = (j < row.size && row[j] != null) ? row[j] : "";
+                            string padded_cell = (cell_text ?? "");
+                            if (padded_cell.length < 5) {
+                                padded_cell = padded_cell + string.nfill(5 - padded_cell.length, ' ');
+                            }
+                            data_row += " %s |".printf(padded_cell);
+                        }
                     }
-                    buffer.insert(ref iter, "\n", -1);
+                    append_text(builder, ref offset, data_row + "\n");
+                }
+                append_text(builder, ref offset, "--- FIN TABLEAU ---\n\n");
+            }
+        }
 
-                    // Récupérer un itérateur valide pour le début
-                    TextIter start;
-                    buffer.get_iter_at_mark(out start, quote_start);
+        private void append_text(StringBuilder builder, ref int offset, string text) {
+            builder.append(text);
+            offset += text.char_count();
+        }
 
-                    // Appliquer le formatage à la citation
-                    buffer.apply_tag(tag_quote, start, iter);
+        /**
+         * Enregistre une plage de tag, en prolongeant la précédente si elle est contiguë
+         */
+        private void add_tag_run(Gee.List<TagRun> tag_runs, Gee.Map<TextTag, TagRun> open_runs,
+                                 TextTag tag, int start, int end) {
+            if (start >= end) {
+                return;
+            }
+            var previous = open_runs[tag];
+            if (previous != null && previous.end == start) {
+                previous.end = end;
+                return;
+            }
+            var run = new TagRun(tag, start, end);
+            tag_runs.add(run);
+            open_runs[tag] = run;
+        }
 
-                    // Supprimer la marque
-                    buffer.delete_mark(quote_start);
-                }
-                else if (node is PivotTable) {
-                    var table = (PivotTable)node;
-                    TextIter current_iter;
-                    buffer.get_iter_at_offset(out current_iter, buffer.get_char_count());
+        // --- Correspondance buffer <-> nœuds ---
 
-                    buffer.insert(ref current_iter, "\n--- TABLEAU ---\n", -1);
-                    // Déterminer le nombre de colonnes (à partir de la première ligne si elle existe)
-                    int num_cols = 0;
-                    if (table.rows.size > 0 && table.rows[0] != null) {
-                        num_cols = table.rows[0].size;
-                    }
+        /**
+         * Retourne le nœud du document affiché à la position donnée
+         */
+        public PivotNode? get_node_at_iter(TextIter iter) {
+            sync_dirty_spans();
+            int index = find_span_index(iter.get_offset());
+            return index >= 0 ? spans[index].node : null;
+        }
 
-                    // En-têtes (simplifié)
-                    string header_row = "|";
-                    string separator_row = "|";
-                    for (int j = 0; j < num_cols; j++) {
-                        header_row += " Col %d |".printf(j + 1);
-                        separator_row += " ----- |";
-                    }
-                    buffer.insert(ref current_iter, header_row + "\n", -1);
-                    buffer.insert(ref current_iter, separator_row + "\n", -1);
-
-                    // Données
-                    foreach (var row in table.rows) {
-                        string data_row = "|";
-                        if (row != null) {
-                            for (int j = 0; j < num_cols; j++) {
-                                // Accéder à la cellule en vérifiant les limites
-                                string? cell_text = (j < row.size && row[j] != null) ? row[j] : "";
-                                string padded_cell = (cell_text ?? "");
-                                if (padded_cell.length < 5) {
-                                    padded_cell = padded_cell + string.nfill(5 - padded_cell.length, ' ');
-                                }
-                                data_row += " %s |".printf(padded_cell);
-                            }
-                        }
-                        buffer.insert(ref current_iter, data_row + "\n", -1);
-                    }
-                    buffer.insert(ref current_iter, "--- FIN TABLEAU ---\n\n", -1);
-                }
+        /**
+         * Retourne la plage du buffer occupée par un nœud du document
+         */
+        public bool get_node_range(PivotNode node, out TextIter start, out TextIter end) {
+            sync_dirty_spans();
+            buffer.get_start_iter(out start);
+            buffer.get_end_iter(out end);
+
+            var span = node_spans[node];
+            if (span == null) {
+                return false;
+            }
+            buffer.get_iter_at_mark(out start, span.start);
+            if (span.index + 1 < spans.size) {
+                buffer.get_iter_at_mark(out end, spans[span.index + 1].start);
             }
+            return true;
+        }
 
-            stderr.printf("🔍 WysiwygEditor.render_pivot_to_buffer: FIN\n");
+        private void add_span(int index, PivotNode node, TextIter start) {
+            var span = new NodeSpan(node, buffer.create_mark(null, start, true));
+            span.index = index;
+            spans.insert(index, span);
+            node_spans[node] = span;
+        }
+
+        private void clear_spans() {
+            foreach (var span in spans) {
+                buffer.delete_mark(span.start);
+            }
+            spans.clear();
+            node_spans.clear();
+            has_dirty_spans = false;
         }
 
         /**
-         * Convertit le contenu actuel du buffer en document pivot
-         * Cette méthode est l'inverse de render_pivot_to_buffer
+         * Indice du dernier nœud commençant avant ou à la position donnée
          */
-        public PivotDocument get_pivot_document() {
-            // Utiliser le document pivot existant comme base ou en créer un nouveau
-            var doc = pivot_doc ?? new PivotDocument();
+        private int find_span_index(int offset) {
+            int low = 0;
+            int high = spans.size - 1;
+            int found = spans.size > 0 ? 0 : -1;
+            TextIter iter;
 
-            // Effacer le contenu existant
-            doc.children.clear();
+            while (low <= high) {
+                int mid = (low + high) / 2;
+                buffer.get_iter_at_mark(out iter, spans[mid].start);
+                if (iter.get_offset() <= offset) {
+                    found = mid;
+                    low = mid + 1;
+                } else {
+                    high = mid - 1;
+                }
+            }
+            return found;
+        }
 
-            // Obtenir le texte complet du buffer avec les balises
-            TextIter start, end;
-            buffer.get_bounds(out start, out end);
+        // --- Suivi des modifications ---
 
-            // Traiter le contenu par paragraphes
-            string full_text = buffer.get_text(start, end, true);
-            string[] paragraphs = full_text.split("\n\n");
+        private void on_insert_text(ref TextIter location, string text, int length) {
+            int offset = location.get_offset();
+            mark_dirty_range(offset, offset);
+        }
 
-            foreach (string para_text in paragraphs) {
-                // Ignorer les paragraphes vides
-                if (para_text.strip() == "")
-                    continue;
+        private void on_delete_range(TextIter start, TextIter end) {
+            mark_dirty_range(start.get_offset(), end.get_offset());
+        }
 
-                // Détecter les titres (par leur taille dans le buffer)
-                bool is_heading1 = false;
-                bool is_heading2 = false;
-                bool is_heading3 = false;
-                bool is_code = false;
-                bool is_quote = false;
-
-                // Vérifier les balises appliquées pour déterminer le type de contenu
-                TextIter para_start, para_end;
-                if (find_paragraph_bounds(para_text, out para_start, out para_end)) {
-                    // Vérifier les tags appliqués au paragraphe
-                    SList<weak TextTag> tags = para_start.get_tags();
-                    foreach (weak TextTag tag in tags) {
-                        if (tag == tag_heading1) is_heading1 = true;
-                        else if (tag == tag_heading2) is_heading2 = true;
-                        else if (tag == tag_heading3) is_heading3 = true;
-                        else if (tag == tag_code) is_code = true;
-                        else if (tag == tag_quote) is_quote = true;
-                    }
+        private void on_tag_changed(TextTag tag, TextIter start, TextIter end) {
+            mark_dirty_range(start.get_offset(), end.get_offset());
+        }
+
+        /**
+         * Marque comme modifiés les nœuds couvrant la plage, ainsi que le suivant :
+         * une édition en bordure peut fusionner deux blocs.
+         */
+        private void mark_dirty_range(int start_offset, int end_offset) {
+            if (loading) {
+                return;
+            }
+
+            if (spans.size > 0) {
+                int first = find_span_index(start_offset);
+                int last = end_offset > start_offset ? find_span_index(end_offset - 1) : first;
+                last = int.min(last + 1, spans.size - 1);
+                for (int i = first; i <= last; i++) {
+                    spans[i].dirty = true;
                 }
+            }
+            has_dirty_spans = true;
+
+            if (sync_timeout_id == 0) {
+                sync_timeout_id = Timeout.add(SYNC_DELAY_MS, () => {
+                    sync_timeout_id = 0;
+                    sync_dirty_spans();
+                    document_changed(pivot_doc);
+                    return Source.REMOVE;
+                });
+            }
+        }
 
-                // Créer le nœud approprié selon le type détecté
-                if (is_heading1 || is_heading2 || is_heading3) {
-                    var heading = new PivotHeading();
-                    heading.text = para_text.strip();
-                    heading.level = is_heading1 ? 1 : (is_heading2 ? 2 : 3);
-                    doc.children.add(heading);
-                }
-                else if (is_code) {
-                    var code_block = new PivotCodeBlock();
-                    // Essayer de détecter le langage s'il est spécifié
-                    string[] code_lines = para_text.split("\n");
-                    if (code_lines.length > 0 && code_lines[0].has_prefix("[") && code_lines[0].has_suffix("]")) {
-                        code_block.language = code_lines[0].substring(1, code_lines[0].length - 2);
-                        // Retirer la ligne de langage
-                        code_block.code = string.joinv("\n", code_lines[1:code_lines.length]);
-                    } else {
-                        code_block.code = para_text;
-                    }
-                    doc.children.add(code_block);
-                }
-                else if (is_quote) {
-                    var quote = new PivotQuote();
-                    // Retirer le préfixe "❝ " si présent
-                    if (para_text.has_prefix("❝ "))
-                        quote.text = para_text.substring(2);
-                    else
-                        quote.text = para_text;
-                    doc.children.add(quote);
-                }
-                else if (para_text.contains("•") && para_text.contains("\n")) {
-                    // Probablement une liste à puces
-                    var list = new PivotList();
-                    list.ordered = false;
-                    string[] list_items = para_text.split("\n");
-                    foreach (string item_text in list_items) {
-                        string trimmed = item_text.strip();
-                        if (trimmed.has_prefix("•")) {
-                            var list_item = new PivotListItem();
-                            list_item.text = trimmed.substring(1).strip(); // Retirer le bullet
-                            list.items.add(list_item);
-                        }
-                    }
-                    if (list.items.size > 0) {
-                        doc.children.add(list);
+        private void cancel_pending_sync() {
+            if (sync_timeout_id != 0) {
+                Source.remove(sync_timeout_id);
+                sync_timeout_id = 0;
+            }
+        }
+
+        /**
+         * Réanalyse uniquement les groupes de nœuds modifiés
+         */
+        private void sync_dirty_spans() {
+            if (!has_dirty_spans) {
+                return;
+            }
+            cancel_pending_sync();
+            if (pivot_doc == null) {
+                pivot_doc = new PivotDocument();
+            }
+
+            if (spans.size == 0) {
+                // Document vide au départ : tout le buffer est nouveau
+                reparse_spans(0, -1);
+            } else {
+                // De la fin vers le début pour garder les indices valides
+                int i = spans.size - 1;
+                while (i >= 0) {
+                    if (!spans[i].dirty) {
+                        i--;
                         continue;
                     }
+                    int last = i;
+                    while (i > 0 && spans[i - 1].dirty) {
+                        i--;
+                    }
+                    reparse_spans(i, last);
+                    i--;
                 }
-
-                // Paragraphe standard avec formatage
-                var pivot_para = new PivotParagraph();
-                pivot_para.segments = extract_formatted_segments(para_text, para_start, para_end);
-                doc.children.add(pivot_para);
             }
-
-            return doc;
+            has_dirty_spans = false;
         }
 
         /**
-         * Trouve les limites d'un paragraphe dans le buffer - Méthode améliorée
+         * Réanalyse la plage des nœuds first..last et remplace ces nœuds dans le document
          */
-        private bool find_paragraph_bounds(string para_text, out TextIter start, out TextIter end) {
-            buffer.get_start_iter(out start);
-            buffer.get_end_iter(out end);
+        private void reparse_spans(int first, int last) {
+            TextIter range_start, range_end;
+            if (first > 0) {
+                buffer.get_iter_at_mark(out range_start, spans[first].start);
+            } else {
+                // Le premier nœud couvre aussi ce qui précède sa marque
+                buffer.get_start_iter(out range_start);
+            }
+            if (last + 1 < spans.size) {
+                buffer.get_iter_at_mark(out range_end, spans[last + 1].start);
+            } else {
+                buffer.get_end_iter(out range_end);
+            }
 
-            // Approche plus sûre : au lieu de rechercher le texte exact,
-            // rechercher ligne par ligne
-            TextIter iter;
-            buffer.get_start_iter(out iter);
+            int base_offset = range_start.get_offset();
+            string text = buffer.get_text(range_start, range_end, true);
+
+            // Découper en blocs séparés par une ligne vide
+            var new_nodes = new Gee.ArrayList<PivotNode>();
+            var new_offsets = new Gee.ArrayList<int>();
+            int pos = 0;
+            int char_pos = base_offset;
+            while (true) {
+                int sep = text.index_of("\n\n", pos);
+                int block_end = sep == -1 ? text.length : sep;
+                string block = text.substring(pos, block_end - pos);
+                int block_chars = block.char_count();
+
+                if (block.strip() != "") {
+                    TextIter block_start, block_stop;
+                    buffer.get_iter_at_offset(out block_start, char_pos);
+                    buffer.get_iter_at_offset(out block_stop, char_pos + block_chars);
+                    new_nodes.add(parse_block(block, block_start, block_stop));
+                    // Le premier bloc reprend le début de la plage (espaces compris)
+                    new_offsets.add(new_nodes.size == 1 ? base_offset : char_pos);
+                }
 
-            while (!iter.is_end()) {
-                TextIter line_start = iter;
-                TextIter line_end = iter;
+                if (sep == -1) {
+                    break;
+                }
+                pos = sep + 2;
+                char_pos += block_chars + 2;
+            }
 
-                line_end.forward_to_line_end();
+            // Remplacer les anciens nœuds par les nouveaux
+            for (int i = last; i >= first; i--) {
+                var old_span = spans.remove_at(i);
+                node_spans.unset(old_span.node);
+                buffer.delete_mark(old_span.start);
+                if (i < pivot_doc.children.size) {
+                    pivot_doc.children.remove_at(i);
+                }
+            }
 
-                // Extraire la ligne
-                string line_text = buffer.get_text(line_start, line_end, false);
+            TextIter start;
+            for (int k = 0; k < new_nodes.size; k++) {
+                int index = int.min(first + k, pivot_doc.children.size);
+                pivot_doc.children.insert(index, new_nodes[k]);
+                buffer.get_iter_at_offset(out start, new_offsets[k]);
+                add_span(first + k, new_nodes[k], start);
+            }
 
-                // Si la ligne contient le début du paragraphe
-                if (line_text.contains(para_text.substring(0, int.min(para_text.length, 30)))) {
-                    start = line_start;
+            for (int i = first; i < spans.size; i++) {
+                spans[i].index = i;
+            }
+        }
 
-                    // Avancer d'autant de caractères qu'il y a dans para_text (approximativement)
-                    TextIter potential_end = start;
-                    potential_end.forward_chars(para_text.length);
+        /**
+         * Convertit le contenu actuel du buffer en document pivot
+         *
+         * Seuls les nœuds modifiés depuis la dernière synchronisation sont
+         * réanalysés ; les autres sont rendus tels quels.
+         */
+        public PivotDocument get_pivot_document() {
+            if (pivot_doc == null) {
+                pivot_doc = new PivotDocument();
+                has_dirty_spans = buffer.get_char_count() > 0;
+            }
+            sync_dirty_spans();
+            return pivot_doc;
+        }
 
-                    // Ne pas dépasser la fin du buffer
-                    if (potential_end.compare(end) > 0) {
-                        potential_end = end;
-                    }
+        /**
+         * Construit le nœud correspondant à un bloc du buffer
+         */
+        private PivotNode parse_block(string para_text, TextIter para_start, TextIter para_end) {
+            // Détecter les titres (par leur taille dans le buffer)
+            bool is_heading1 = false;
+            bool is_heading2 = false;
+            bool is_heading3 = false;
+            bool is_code = false;
+            bool is_quote = false;
+
+            // Vérifier les tags appliqués au début du bloc
+            SList<weak TextTag> tags = para_start.get_tags();
+            foreach (weak TextTag tag in tags) {
+                if (tag == tag_heading1) is_heading1 = true;
+                else if (tag == tag_heading2) is_heading2 = true;
+                else if (tag == tag_heading3) is_heading3 = true;
+                else if (tag == tag_code) is_code = true;
+                else if (tag == tag_quote) is_quote = true;
+            }
 
-                    end = potential_end;
-                    return true;
+            // Créer le nœud approprié selon le type détecté
+            if (is_heading1 || is_heading2 || is_heading3) {
+                var heading = new PivotHeading();
+                heading.text = para_text.strip();
+                heading.level = is_heading1 ? 1 : (is_heading2 ? 2 : 3);
+                return heading;
+            }
+            else if (is_code) {
+                var code_block = new PivotCodeBlock();
+                // Essayer de détecter le langage s'il est spécifié
+                string[] code_lines = para_text.split("\n");
+                if (code_lines.length > 0 && code_lines[0].has_prefix("[") && code_lines[0].has_suffix("]")) {
+                    code_block.language = code_lines[0].substring(1, code_lines[0].length - 2);
+                    // Retirer la ligne de langage
+                    code_block.code = string.joinv("\n", code_lines[1:code_lines.length]);
+                } else {
+                    code_block.code = para_text;
                 }
-
-                // Passer à la ligne suivante
-                if (!iter.forward_line()) {
-                    break;
+                return code_block;
+            }
+            else if (is_quote) {
+                var quote = new PivotQuote();
+                // Retirer le préfixe "❝ " si présent
+                if (para_text.has_prefix("❝ "))
+                    quote.text = para_text.substring("❝ ".length);
+                else
+                    quote.text = para_text;
+                return quote;
+            }
+            else if (para_text.strip().has_prefix("•")) {
+                // Liste à puces
+                var list = new PivotList();
+                list.ordered = false;
+                string[] list_items = para_text.split("\n");
+                foreach (string item_text in list_items) {
+                    string trimmed = item_text.strip();
+                    if (trimmed.has_prefix("•")) {
+                        var list_item = new PivotListItem();
+                        list_item.text = trimmed.substring("•".length).strip(); // Retirer le bullet
+                        list.items.add(list_item);
+                    }
+                }
+                if (list.items.size > 0) {
+                    return list;
                 }
             }
 
-            // Paragraphe non trouvé, retourner les itérateurs du début et de la fin
-            return false;
+            // Paragraphe standard avec formatage
+            var pivot_para = new PivotParagraph();
+            pivot_para.segments = extract_formatted_segments(para_text, para_start, para_end);
+            return pivot_para;
         }
 
         /**
@@ -745,17 +983,17 @@ namespace Sambo {
                 string segment_text = buffer.get_text(current, segment_end, false);
 
                 // Détecter le formatage appliqué
-                var formats = new Gee.HashSet<TextFormatting>();
+                uint formats = 0;
                 if (current.has_tag(tag_bold))
-                    formats.add(TextFormatting.BOLD);
+                    formats |= TextFormatting.BOLD.to_flag();
                 if (current.has_tag(tag_italic))
-                    formats.add(TextFormatting.ITALIC);
+                    formats |= TextFormatting.ITALIC.to_flag();
                 if (current.has_tag(tag_strikethrough))
-                    formats.add(TextFormatting.STRIKETHROUGH);
+                    formats |= TextFormatting.STRIKETHROUGH.to_flag();
                 if (current.has_tag(tag_code))
-                    formats.add(TextFormatting.CODE);
+                    formats |= TextFormatting.CODE.to_flag();
                 if (current.has_tag(tag_underline) || buffer.get_tag_table().lookup("underline") != null)
-                    formats.add(TextFormatting.UNDERLINE);
+                    formats |= TextFormatting.UNDERLINE.to_flag();
 
                 // Créer le segment
                 segments.add(new TextSegment(segment_text, formats));
@@ -905,5 +1143,36 @@ namespace Sambo {
             line = iter.get_line();
             column = iter.get_line_offset();
         }
+
+        /**
+         * Plage du buffer associée à un nœud, délimitée par sa marque de début
+         * et celle du nœud suivant
+         */
+        private class NodeSpan : Object {
+            public PivotNode node;
+            public TextMark start;
+            public int index;
+            public bool dirty = false;
+
+            public NodeSpan(PivotNode node, TextMark start) {
+                this.node = node;
+                this.start = start;
+            }
+        }
+
+        /**
+         * Plage de tag à appliquer après le chargement
+         */
+        private class TagRun : Object {
+            public TextTag tag;
+            public int start;
+            public int end;
+
+            public TagRun(TextTag tag, int start, int end) {
+                this.tag = tag;
+                this.start = start;
+                this.end = end;
+            }
+        }
     }
 }
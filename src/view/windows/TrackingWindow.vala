@@ -7,6 +7,15 @@ public class TrackingWindow : Adw.Window {
     private ApplicationController controller;
     private Adw.ToastOverlay toast_overlay;
 
+    // Traitements par lot
+    private BatchJobManager batch_jobs;
+    private Adw.PreferencesGroup batch_section;
+    private Label batch_empty_label;
+    private Gee.HashMap<BatchJob, BatchJobRow> batch_rows = new Gee.HashMap<BatchJob, BatchJobRow>();
+    private ulong job_added_handler = 0;
+    private ulong job_state_handler = 0;
+    private ulong job_progress_handler = 0;
+
     public TrackingWindow(ApplicationController controller) {
         Object(
             title: "Suivi Sambo - Tableau de Bord",
@@ -15,7 +24,9 @@ public class TrackingWindow : Adw.Window {
             resizable: true
         );
         this.controller = controller;
+        this.batch_jobs = controller.get_batch_job_manager();
         setup_ui();
+        connect_batch_signals();
     }
 
     private void setup_ui() {
@@ -77,6 +88,9 @@ public class TrackingWindow : Adw.Window {
         header_container.append(icon_title_box);
         content_box.append(header_container);
 
+        // Section Traitements par lot
+        content_box.append(create_batch_jobs_section());
+
         // Section Fonctionnalités
         content_box.append(create_features_section());
 
@@ -94,6 +108,53 @@ public class TrackingWindow : Adw.Window {
         apply_custom_styles();
     }
 
+    private Widget create_batch_jobs_section() {
+        batch_section = new Adw.PreferencesGroup();
+        batch_section.set_title("⚙️ Traitements par lot");
+        batch_section.set_description("Progression et débit des traitements lancés depuis l'explorateur");
+
+        batch_empty_label = new Label("Aucun traitement par lot");
+        batch_empty_label.add_css_class("dim-label");
+        batch_empty_label.set_margin_top(12);
+        batch_empty_label.set_margin_bottom(12);
+        batch_section.add(batch_empty_label);
+
+        foreach (var job in batch_jobs.get_jobs()) {
+            add_batch_row(job);
+        }
+        return batch_section;
+    }
+
+    private void add_batch_row(BatchJob job) {
+        if (batch_rows.has_key(job)) return;
+
+        var row = new BatchJobRow(job, batch_jobs, controller.get_config_manager());
+        batch_rows[job] = row;
+        batch_section.add(row);
+        batch_empty_label.set_visible(false);
+    }
+
+    private void connect_batch_signals() {
+        job_added_handler = batch_jobs.job_added.connect((job) => {
+            add_batch_row(job);
+        });
+        job_state_handler = batch_jobs.job_state_changed.connect((job) => {
+            var row = batch_rows[job];
+            if (row != null) row.update();
+        });
+        job_progress_handler = batch_jobs.job_progress.connect((job) => {
+            var row = batch_rows[job];
+            if (row != null) row.update();
+        });
+
+        close_request.connect(() => {
+            batch_jobs.disconnect(job_added_handler);
+            batch_jobs.disconnect(job_state_handler);
+            batch_jobs.disconnect(job_progress_handler);
+            return false;
+        });
+    }
+
     private Widget create_features_section() {
         var section = new Adw.PreferencesGroup();
         section.set_title("🚀 Fonctionnalités de Sambo");
@@ -438,6 +499,95 @@ Pour les tâches partiellement terminées :
         toast.set_timeout(3);
         toast_overlay.add_toast(toast);
     }
+
+    /**
+     * Ligne de suivi d'un traitement par lot : progression, débit et commandes
+     */
+    private class BatchJobRow : Adw.ActionRow {
+        private BatchJob job;
+        private BatchJobManager manager;
+        private ProgressBar progress_bar;
+        private Button pause_button;
+        private Button cancel_button;
+
+        public BatchJobRow(BatchJob job, BatchJobManager manager, ConfigManager config) {
+            this.job = job;
+            this.manager = manager;
+
+            var profile = config.get_profile(job.profile_id);
+            string first_line = job.instruction.split("\n", 2)[0];
+            set_title(GLib.Markup.escape_text(first_line));
+            if (profile != null) {
+                set_tooltip_text("Profil : %s".printf(profile.title));
+            }
+
+            progress_bar = new ProgressBar();
+            progress_bar.set_valign(Align.CENTER);
+            progress_bar.set_size_request(160, -1);
+            add_suffix(progress_bar);
+
+            pause_button = new Button();
+            pause_button.set_valign(Align.CENTER);
+            pause_button.add_css_class("flat");
+            pause_button.clicked.connect(() => {
+                if (job.state == BatchJobState.PAUSED) {
+                    manager.resume(job);
+                } else {
+                    manager.pause(job);
+                }
+                update();
+            });
+            add_suffix(pause_button);
+
+            cancel_button = new Button.from_icon_name("process-stop-symbolic");
+            cancel_button.set_valign(Align.CENTER);
+            cancel_button.set_tooltip_text("Annuler le traitement");
+            cancel_button.add_css_class("flat");
+            cancel_button.clicked.connect(() => {
+                manager.cancel(job);
+                update();
+            });
+            add_suffix(cancel_button);
+
+            update();
+        }
+
+        public void update() {
+            int completed = job.get_completed();
+            int total = job.get_total();
+            progress_bar.set_fraction(job.get_progress());
+
+            var subtitle = new StringBuilder();
+            subtitle.append("%s · %d/%d fichiers".printf(job.state.to_label(), completed, total));
+            if (job.get_failed() > 0) {
+                subtitle.append(" · %d échecs".printf(job.get_failed()));
+            }
+            if (job.get_truncated() > 0) {
+                subtitle.append(" · %d tronqués".printf(job.get_truncated()));
+            }
+            double files_per_minute = job.get_files_per_minute();
+            if (job.state == BatchJobState.RUNNING && files_per_minute > 0) {
+                double remaining_minutes = (total - completed) / files_per_minute;
+                subtitle.append(" · %.1f tokens/s · %.1f fichiers/min · reste ~%.0f min".printf(
+                    job.get_tokens_per_second(), files_per_minute, remaining_minutes));
+            }
+            if (job.last_error != null) {
+                subtitle.append(" · " + job.last_error);
+            }
+            set_subtitle(GLib.Markup.escape_text(subtitle.str));
+
+            bool active = job.state != BatchJobState.COMPLETED && job.state != BatchJobState.CANCELLED;
+            pause_button.set_visible(active);
+            cancel_button.set_visible(active);
+            if (job.state == BatchJobState.PAUSED) {
+                pause_button.set_icon_name("media-playback-start-symbolic");
+                pause_button.set_tooltip_text("Reprendre le traitement");
+            } else {
+                pause_button.set_icon_name("media-playback-pause-symbolic");
+                pause_button.set_tooltip_text("Mettre en pause");
+            }
+        }
+    }
 }
 
 }